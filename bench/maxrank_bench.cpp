@@ -0,0 +1,430 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cell.h"
+#include "datagen.h"
+#include "dominanceindex.h"
+#include "halfspace.h"
+#include "mbrbatch.h"
+#include "qtree.h"
+#include "query.h"
+#include "utils.h"
+
+/**
+ * Microbenchmarks for the hot kernels of the MaxRank engine.
+ *
+ * Every kernel runs on inputs generated with a fixed seed, so two runs of the same
+ * binary time exactly the same work. Results are written as JSON (one benchmark per
+ * line) and can be compared against a previous run with --baseline: any kernel whose
+ * median time grew by more than --threshold (relative) is reported as a regression and
+ * the process exits with code 2. Without --out the JSON goes to stdout; progress and the
+ * comparison always go to stderr.
+ *
+ * Usage: maxrank_bench [--out=results.json] [--baseline=old.json]
+ *                      [--threshold=0.10] [--reps=7] [--filter=substring]
+ */
+
+extern int numOfSubdivisions;
+
+namespace {
+
+constexpr unsigned int kSeed = 42;
+
+struct BenchResult {
+    std::string name;
+    int reps;
+    long ops;             ///< Kernel invocations per repetition
+    double medianNs;      ///< Median time per invocation (ns)
+    double minNs;         ///< Best time per invocation (ns)
+};
+
+struct BenchOptions {
+    std::string outFile;
+    std::string baselineFile;
+    std::string filter;
+    double threshold = 0.10;
+    int reps = 7;
+};
+
+BenchOptions options;
+std::vector<BenchResult> results;
+
+/**
+ * \brief Times \p body (which performs \p ops kernel invocations) options.reps times.
+ */
+void runBench(const std::string& name, const long ops, const std::function<void()>& body) {
+    if (!options.filter.empty() && name.find(options.filter) == std::string::npos) return;
+
+    body(); // warm-up (caches, allocator, lazily read files)
+
+    std::vector<double> perOp;
+    perOp.reserve(options.reps);
+    for (int r = 0; r < options.reps; ++r) {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const auto end = std::chrono::steady_clock::now();
+        const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+        perOp.push_back(ns / static_cast<double>(std::max(1L, ops)));
+    }
+    std::sort(perOp.begin(), perOp.end());
+
+    BenchResult res{name, options.reps, ops, perOp[perOp.size() / 2], perOp.front()};
+    std::cerr << "  " << name << ": " << res.medianNs << " ns/op (min " << res.minNs << ")" << std::endl;
+    results.push_back(res);
+}
+
+/**
+ * \brief Resets the global halfspace caches used by genhalfspaces / QNode.
+ */
+void resetHalfspaceCache(const size_t cacheSize) {
+    delete halfspaceCache;
+    halfspaceCache = nullptr;
+    pointToHalfSpaceCache.clear();
+    initializeCache(cacheSize);
+}
+
+/**
+ * \brief Builds the halfspaces of a query point against a synthetic dataset, like aa_hd does
+ *        for the first expansion cycle (skyline of the incomparable records).
+ */
+std::vector<long> queryHalfspaces(const std::vector<Point>& data, const Point& p) {
+    resetHalfspaceCache(data.size());
+    const std::vector<Point> sky = getskyline(getincomparables(data, p));
+    return genhalfspaces(p, sky);
+}
+
+/**
+ * \brief Picks a query point of the dataset with a mid-range coordinate sum.
+ */
+const Point& middlePoint(const std::vector<Point>& data) {
+    std::vector<std::pair<double, size_t>> sums;
+    sums.reserve(data.size());
+    for (size_t i = 0; i < data.size(); ++i) {
+        double s = 0.0;
+        for (const double c : data[i].coord) s += c;
+        sums.emplace_back(s, i);
+    }
+    std::nth_element(sums.begin(), sums.begin() + sums.size() / 4, sums.end());
+    return data[sums[sums.size() / 4].second];
+}
+
+void benchHammingStrings() {
+    std::cerr << "genhammingstrings" << std::endl;
+    for (const int len : {10, 15, 21}) {
+        for (const int weight : {1, 2, 3, 4}) {
+            const std::string name = "genhammingstrings/len=" + std::to_string(len) + "/w=" + std::to_string(weight);
+            runBench(name, 1, [&]() {
+                auto strings = genhammingstrings(len, weight);
+                if (strings.empty()) std::cerr << "unexpected empty result" << std::endl;
+            });
+        }
+    }
+}
+
+void benchLinprog() {
+    std::cerr << "linprog_highs" << std::endl;
+    std::mt19937 gen(kSeed);
+    std::uniform_real_distribution<double> unif(-1.0, 1.0);
+
+    for (const int dims : {2, 4, 8}) {
+        for (const int rows : {5, 20}) {
+            // Same shape as searchmincells_lp: dims weights + 1 slack variable, maximize slack
+            constexpr int numLPs = 50;
+            std::vector<std::vector<std::vector<double>>> As(numLPs);
+            std::vector<std::vector<double>> bs(numLPs);
+            for (int k = 0; k < numLPs; ++k) {
+                As[k].assign(rows + 1, std::vector<double>(dims + 1, 1.0));
+                bs[k].assign(rows + 1, 1.0);
+                for (int r = 0; r < rows; ++r) {
+                    for (int d = 0; d < dims; ++d) As[k][r][d] = unif(gen);
+                    bs[k][r] = 0.5 * unif(gen);
+                }
+                As[k][rows][dims] = 0.0;
+            }
+            std::vector<double> c(dims + 1, 0.0);
+            c[dims] = -1.0;
+            std::vector<std::pair<double, double>> bounds(dims + 1, {0.0, 1.0});
+            bounds[dims] = {0.0, std::numeric_limits<double>::infinity()};
+
+            const std::string name = "linprog_highs/d=" + std::to_string(dims) + "/rows=" + std::to_string(rows);
+            runBench(name, numLPs, [&]() {
+                for (int k = 0; k < numLPs; ++k) {
+                    auto res = linprog_highs(c, As[k], bs[k], bounds);
+                    (void)res;
+                }
+            });
+        }
+    }
+}
+
+void benchSkyline() {
+    std::cerr << "getskyline" << std::endl;
+    for (const auto dist : {Distribution::INDEPENDENT, Distribution::CORRELATED, Distribution::ANTICORRELATED}) {
+        for (const int dims : {3, 5}) {
+            const std::vector<Point> data = gendata(dist, 10000, dims, kSeed);
+            const std::string name = "getskyline/" + distributionName(dist) + "/n=10000/d=" + std::to_string(dims);
+            runBench(name, 1, [&]() {
+                auto sky = getskyline(data);
+                (void)sky;
+            });
+        }
+    }
+}
+
+void benchPartition() {
+    std::cerr << "getpartition / DominanceIndex::partition" << std::endl;
+    for (const auto dist : {Distribution::INDEPENDENT, Distribution::ANTICORRELATED}) {
+        for (const int dims : {3, 5, 8}) {
+            const std::vector<Point> data = gendata(dist, 100000, dims, kSeed);
+            const Point& p = middlePoint(data);
+            const std::string name = "getpartition/" + distributionName(dist) + "/n=100000/d=" + std::to_string(dims);
+            runBench(name, 1, [&]() {
+                auto part = getpartition(data, p);
+                (void)part;
+            });
+            const DominanceIndex index(data);
+            runBench("DominanceIndex::partition/" + distributionName(dist) + "/n=100000/d=" + std::to_string(dims), 1, [&]() {
+                auto part = index.partition(p);
+                (void)part;
+            });
+        }
+    }
+}
+
+void benchMacroSplit() {
+    std::cerr << "QTree::inserthalfspacesMacroSplit" << std::endl;
+    for (int dims = 3; dims <= 9; ++dims) {
+        const std::vector<Point> data = gendata(Distribution::INDEPENDENT, 2000, dims, kSeed);
+        const Point& p = middlePoint(data);
+        const std::vector<long> halfspaces = queryHalfspaces(data, p);
+
+        // QTree works in the reduced (dims - 1) weight space
+        const int qdims = dims - 1;
+        numOfSubdivisions = 1 << qdims;
+        const int maxLevel = dims <= 5 ? 5 : 3;
+
+        const std::string name = "inserthalfspacesMacroSplit/d=" + std::to_string(dims) +
+                                 "/hs=" + std::to_string(halfspaces.size());
+        runBench(name, 1, [&]() {
+            QTree qt(qdims, 20, maxLevel);
+            qt.inserthalfspacesMacroSplit(halfspaces);
+        });
+        runBench(name + "/split=widest", 1, [&]() {
+            QTree qt(qdims, 20, maxLevel, QTreeSplit::WIDEST);
+            qt.inserthalfspacesMacroSplit(halfspaces);
+        });
+        runBench(name + "/split=halfspaces", 1, [&]() {
+            QTree qt(qdims, 20, maxLevel, QTreeSplit::HALFSPACES);
+            qt.inserthalfspacesMacroSplit(halfspaces);
+        });
+        runBench(name + "/position=balanced", 1, [&]() {
+            QTree qt(qdims, 20, maxLevel, QTreeSplit::QUAD, SplitPosition::BALANCED);
+            qt.inserthalfspacesMacroSplit(halfspaces);
+        });
+    }
+}
+
+void benchMbrClassify() {
+    std::cerr << "exactMbrPosition / MbrBatch::classify" << std::endl;
+    for (const int dims : {4, 6, 8}) {
+        const std::vector<Point> data = gendata(Distribution::INDEPENDENT, 2000, dims, kSeed);
+        const std::vector<long> ids = queryHalfspaces(data, middlePoint(data));
+        std::vector<std::shared_ptr<HalfSpace>> hs;
+        for (const long id : ids) hs.push_back(halfspaceCache->get(id));
+
+        // The children of a QNode: all 2^(dims-1) subdivisions of a box
+        const int qdims = dims - 1;
+        const QTree qt(qdims, 20, 1);
+        const auto& boxes = qt.precomputedSubMBRs;
+        const MbrBatch batch(boxes);
+        std::vector<PositionHS> positions(boxes.size());
+
+        const std::string suffix = "/d=" + std::to_string(dims) + "/boxes=" + std::to_string(boxes.size());
+        // A pass over the halfspaces takes a few microseconds: repeat it to about 2^20 boxes per rep
+        const long pass = static_cast<long>(hs.size() * boxes.size());
+        const long passes = std::max(1L, (1L << 20) / pass);
+        runBench("exactMbrPosition" + suffix, pass * passes, [&]() {
+            for (long r = 0; r < passes; ++r) {
+                for (const auto& h : hs) {
+                    for (size_t b = 0; b < boxes.size(); ++b) {
+                        positions[b] = exactMbrPosition(h->coeff, h->known,
+                                                        [&](const size_t d) { return boxes[b][d][0]; },
+                                                        [&](const size_t d) { return boxes[b][d][1]; });
+                    }
+                }
+            }
+        });
+        // The portable path under its own name, the AVX-512 one (if the CPU has it) under the old one
+        const bool avx512 = MbrBatch::avx512();
+        MbrBatch::setAvx512(false);
+        runBench("MbrBatch::classify/portable" + suffix, pass * passes, [&]() {
+            for (long r = 0; r < passes; ++r) {
+                for (const auto& h : hs) batch.classify(h->coeff, h->known, positions.data());
+            }
+        });
+        MbrBatch::setAvx512(avx512);
+        if (avx512) {
+            runBench("MbrBatch::classify" + suffix, pass * passes, [&]() {
+                for (long r = 0; r < passes; ++r) {
+                    for (const auto& h : hs) batch.classify(h->coeff, h->known, positions.data());
+                }
+            });
+        }
+    }
+}
+
+void benchMbrIsValid() {
+    std::cerr << "MbrIsValid" << std::endl;
+    std::mt19937 gen(kSeed);
+    std::uniform_real_distribution<float> unif(0.0f, 1.0f);
+
+    for (const int dims : {2, 4, 8, 12, 16}) {
+        constexpr int numMBRs = 1000;
+        std::vector<std::vector<std::array<float, 2>>> mbrs(numMBRs, std::vector<std::array<float, 2>>(dims));
+        for (auto& mbr : mbrs) {
+            for (auto& range : mbr) {
+                const float a = unif(gen) * 0.6f;
+                const float b = unif(gen) * 0.6f;
+                range = {std::min(a, b), std::max(a, b)};
+            }
+        }
+
+        const std::string name = "MbrIsValid/d=" + std::to_string(dims);
+        runBench(name, numMBRs, [&]() {
+            int valid = 0;
+            for (const auto& mbr : mbrs) {
+                valid += MbrIsValid(mbr) ? 1 : 0;
+            }
+            if (valid < 0) std::cerr << valid << std::endl;
+        });
+    }
+}
+
+void writeJSON(std::ostream& out) {
+    out << "{\n  \"seed\": " << kSeed << ",\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        out << "    {\"name\": \"" << r.name << "\", \"reps\": " << r.reps << ", \"ops\": " << r.ops
+            << ", \"median_ns\": " << r.medianNs << ", \"min_ns\": " << r.minNs << "}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+/**
+ * \brief Reads "name" -> median_ns from a JSON file previously written by writeJSON.
+ */
+std::map<std::string, double> readBaseline(const std::string& filename) {
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open baseline file: " + filename);
+    }
+    std::map<std::string, double> baseline;
+    std::string line;
+    while (std::getline(in, line)) {
+        const size_t n = line.find("\"name\": \"");
+        const size_t m = line.find("\"median_ns\": ");
+        if (n == std::string::npos || m == std::string::npos) continue;
+        const size_t nameStart = n + 9;
+        const std::string name = line.substr(nameStart, line.find('"', nameStart) - nameStart);
+        baseline[name] = std::stod(line.substr(m + 13));
+    }
+    return baseline;
+}
+
+/**
+ * \brief Compares the current results against a baseline.
+ * \return The number of regressions beyond options.threshold.
+ */
+int compareBaseline(const std::map<std::string, double>& baseline) {
+    int regressions = 0;
+    std::cerr << "\nComparison against " << options.baselineFile
+              << " (threshold " << options.threshold * 100 << "%)" << std::endl;
+    for (const auto& r : results) {
+        const auto it = baseline.find(r.name);
+        if (it == baseline.end() || it->second <= 0) continue;
+        const double change = r.medianNs / it->second - 1.0;
+        const bool regressed = change > options.threshold;
+        regressions += regressed ? 1 : 0;
+        std::cerr << (regressed ? "  REGRESSION " : "  ok         ") << r.name << ": "
+                  << it->second << " -> " << r.medianNs << " ns/op ("
+                  << (change >= 0 ? "+" : "") << change * 100 << "%)" << std::endl;
+    }
+    return regressions;
+}
+
+void parseBenchArgs(const int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eqPos = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eqPos == std::string::npos) {
+            std::cerr << "Ignoring unrecognized argument: " << arg << std::endl;
+            continue;
+        }
+        const std::string key = arg.substr(2, eqPos - 2);
+        const std::string val = arg.substr(eqPos + 1);
+        if (key == "out") {
+            options.outFile = val;
+        } else if (key == "baseline") {
+            options.baselineFile = val;
+        } else if (key == "threshold") {
+            options.threshold = std::stod(val);
+        } else if (key == "reps") {
+            options.reps = std::max(1, std::stoi(val));
+        } else if (key == "filter") {
+            options.filter = val;
+        } else {
+            std::cerr << "Unknown parameter: --" << key << std::endl;
+        }
+    }
+}
+
+} // namespace
+
+int main(const int argc, char* argv[]) {
+    try {
+        parseBenchArgs(argc, argv);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid benchmark argument: " << e.what() << std::endl;
+        return 1;
+    }
+
+    benchHammingStrings();
+    benchLinprog();
+    benchPartition();
+    benchSkyline();
+    benchMacroSplit();
+    benchMbrClassify();
+    benchMbrIsValid();
+
+    if (options.outFile.empty()) {
+        writeJSON(std::cout);
+    } else {
+        std::ofstream out(options.outFile);
+        writeJSON(out);
+        std::cerr << "Results written to " << options.outFile << std::endl;
+    }
+
+    if (!options.baselineFile.empty()) {
+        try {
+            const int regressions = compareBaseline(readBaseline(options.baselineFile));
+            if (regressions > 0) {
+                std::cerr << regressions << " benchmark(s) regressed." << std::endl;
+                return 2;
+            }
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
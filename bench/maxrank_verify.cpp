@@ -0,0 +1,1052 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <numeric>
+#include <optional>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "batch2d.h"
+#include "cell.h"
+#include "config.h"
+#include "csvutils.h"
+#include "datagen.h"
+#include "dominanceindex.h"
+#include "dynamic.h"
+#include "maxrank.h"
+#include "mbrbatch.h"
+#include "metrics.h"
+#include "query.h"
+#include "reverse.h"
+
+/**
+ * Regression harness: checks aa_hd against brute-force oracles.
+ *
+ *  - Sampling oracle: p's rank is computed for many weight vectors of the simplex
+ *    (random, on random faces, vertices and centroid) with a plain scan over the data,
+ *    independent of the engine's sampler; the best sampled rank is an upper bound of the
+ *    true MaxRank.
+ *  - Exhaustive oracle (tiny inputs): every subset of incomparable records, by
+ *    increasing size, is tested for a non-empty cell with an LP; the first feasible
+ *    size gives the exact MaxRank.
+ *  - Witness: p's rank at the weight vector returned with the first mincell must be
+ *    equal to the reported MaxRank.
+ *  - Reference files: examples/<Test>/ResultsBF250.csv hold sampled brute-force ranks
+ *    (upper bounds as well).
+ *
+ * Before the queries, the structures that must give the same answers as a plain scan are
+ * checked on fixed-seed inputs: DominanceIndex against getpartition, MbrBatch against
+ * exactMbrPosition, and the 2D engines (aa_2d, aa_2d_batch) against an exact 2D MaxRank computed
+ * in integers on data with ties. DynamicDataset is run through random inserts and deletes, and
+ * every result it keeps is compared with a full recompute. reverseMaxRank must return exactly
+ * the records whose MaxRank (one query each) is within k.
+ *
+ * Every dataset is run once per engine configuration (maxLevelQTree, maxCapacityQNode)
+ * and the wall time is reported for each. --engine sets the other engine options for the
+ * whole run, with the flags of MaxRankProject (e.g. --engine=qtree-split=1,bound-samples=0);
+ * each option set the engine supports is registered as its own ctest.
+ *
+ * A query that reaches the memory budget (--engine=memory-budget=MB) or whose leaf searches
+ * were cut short by limitHamWeight or halfspacesLengthLimit (limits_hit > 0) may report an
+ * upper bound: it must then not go below the exhaustive oracle and must match the rank at its
+ * witness, while a gap to the sampled and reference upper bounds is reported as "approximate"
+ * instead of failing. With a memory budget the run fails if no query reached it. --datasets
+ * keeps only the datasets whose name starts with one of the given prefixes.
+ *
+ * With --decision=1 every query is also run in decision mode (rankThreshold) at the
+ * thresholds m - 1 and m, where m is the MaxRank of the exhaustive oracle, else that of the
+ * full search (checked above): the answer must be "reachable" exactly when m <= threshold,
+ * and a reachable answer must come with a rank within the threshold at its witness.
+ *
+ * Known mismatches of the engine are listed in an expected-mismatch baseline, each after the
+ * comment that justifies it: a listed query passes as long as its maxrank does not grow past
+ * the recorded one. Truncated queries are not baselined, they are reported as approximate. The
+ * exit code is 1 if any other check fails, so a regression (a new mismatch or a worse result)
+ * turns the run red. Baseline entries that no longer mismatch
+ * are reported; --write-baseline=<file> regenerates the entries of the current engine
+ * options from the current run and keeps those of the other option sets.
+ *
+ * Usage: maxrank_verify [--examples=<dir>] [--random=<datasets>] [--datasets=prefix,...] [--samples=<weights>]
+ *                       [--configs=level:capacity,...] [--engine=flag=value,...] [--decision=0|1]
+ *                       [--baseline=<file>] [--write-baseline=<file>]
+ */
+
+namespace {
+
+struct VerifyOptions {
+    std::filesystem::path examples = std::filesystem::path(__FILE__).parent_path() / "../examples";
+    int randomDatasets = 6;
+    std::vector<std::string> datasets;        ///< Name prefixes of the datasets to run (empty = all)
+    int samples = 100000;
+    std::vector<std::pair<int, int>> configs = {{5, 20}, {6, 5}, {8, 10}};
+    std::string engine = "default";           ///< Engine flags of the run ("default" = none)
+    bool decision = false;                    ///< Also check decision mode around the exact MaxRank
+    std::filesystem::path baseline = std::filesystem::path(__FILE__).parent_path() / "maxrank_verify_expected.csv";
+    std::string writeBaseline;                ///< If set, the current mismatches are written there
+};
+
+/// (dataset, engine flags, maxLevelQTree, maxCapacityQNode, id) of a query checked in one configuration
+using MismatchKey = std::tuple<std::string, std::string, int, int, int>;
+
+struct Dataset {
+    std::string name;
+    std::vector<Point> data;
+    std::vector<int> queries;                 ///< 1-based ids
+    std::map<int, int> reference;             ///< id -> reference rank (upper bound), if any
+};
+
+constexpr int kExhaustiveMaxIncomparables = 14;
+constexpr double kEps = 1e-9;
+
+/**
+ * \brief Rank of p under the weight vector w: 1 + number of records with a strictly lower score.
+ */
+int rankAt(const std::vector<Point>& data, const Point& p, const std::vector<double>& w) {
+    double ps = 0.0;
+    for (int d = 0; d < p.dims; ++d) ps += w[d] * p.coord[d];
+    int below = 0;
+    for (const auto& r : data) {
+        double s = 0.0;
+        for (int d = 0; d < p.dims; ++d) s += w[d] * r.coord[d];
+        below += (s < ps - kEps) ? 1 : 0;
+    }
+    return below + 1;
+}
+
+/**
+ * \brief Sampling oracle over the weight simplex. Weights and scores are computed here with
+ *        rankAt(), not with the engine's RankSampler, so a fault of the sampler shows up as a
+ *        disagreement.
+ */
+class SamplingOracle {
+public:
+    SamplingOracle(const std::vector<Point>& data, const int samples, const unsigned int seed)
+        : data(data) {
+        const int dims = data.front().dims;
+        // Vertices and centroid, then uniform weights (normalized exponentials); every fourth
+        // lies on a face, with a random subset of the weights set to zero
+        for (int d = 0; d < dims; ++d) {
+            weights.emplace_back(dims, 0.0);
+            weights.back()[d] = 1.0;
+        }
+        weights.emplace_back(dims, 1.0 / dims);
+        std::mt19937 gen(seed);
+        std::exponential_distribution<double> expo(1.0);
+        std::uniform_int_distribution<int> coin(0, 1);
+        for (int s = 0; s < samples; ++s) {
+            std::vector<double> w(dims);
+            double sum = 0.0;
+            for (auto& v : w) {
+                v = (s % 4 == 0 && coin(gen) == 0) ? 0.0 : expo(gen);
+                sum += v;
+            }
+            if (sum <= 0.0) continue;
+            for (auto& v : w) v /= sum;
+            weights.push_back(std::move(w));
+        }
+    }
+
+    /**
+     * \brief Best sampled rank of p (an upper bound of its MaxRank).
+     */
+    [[nodiscard]] int bestRank(const Point& p) const {
+        int best = static_cast<int>(data.size()) + 1;
+        for (const auto& w : weights) {
+            best = std::min(best, rankAt(data, p, w));
+            if (best == 1) break;
+        }
+        return best;
+    }
+
+private:
+    const std::vector<Point>& data;
+    std::vector<std::vector<double>> weights;   ///< Sampled weight vectors (sum = 1)
+};
+
+/**
+ * \brief Exact MaxRank by exhaustive enumeration of the incomparable records' subsets.
+ * \return The exact MaxRank, or -1 if p has too many incomparable records.
+ */
+int exhaustiveMaxRank(const std::vector<Point>& data, const Point& p) {
+    const int dims = p.dims - 1;  // reduced weight space, as in aa_hd
+    int dominators = 0;
+    std::vector<std::vector<double>> coeffs;
+    std::vector<double> knowns;
+
+    for (const auto& r : data) {
+        bool less = false, greater = false;
+        for (int d = 0; d < p.dims; ++d) {
+            if (r.coord[d] < p.coord[d]) less = true;
+            if (r.coord[d] > p.coord[d]) greater = true;
+        }
+        if (less && !greater) dominators++;
+        if (!(less && greater)) continue;
+
+        // r scores lower than p iff coeff . q < known (same halfspace as genhalfspaces)
+        std::vector<double> coeff(dims);
+        for (int d = 0; d < dims; ++d) {
+            coeff[d] = (r.coord[d] - r.coord[dims]) - (p.coord[d] - p.coord[dims]);
+        }
+        coeffs.push_back(coeff);
+        knowns.push_back(p.coord[dims] - r.coord[dims]);
+    }
+    const int m = static_cast<int>(coeffs.size());
+    if (m > kExhaustiveMaxIncomparables) return -1;
+
+    // Maximize the slack t of every constraint: the cell is non-empty iff t > 0
+    std::vector<double> c(dims + 1, 0.0);
+    c[dims] = -1.0;
+    std::vector<std::pair<double, double>> bounds(dims + 1, {0.0, 1.0});
+    std::vector<std::vector<double>> A(m + 1, std::vector<double>(dims + 1, 1.0));
+    std::vector<double> b(m + 1, 1.0);
+
+    for (int k = 0; k <= m; ++k) {
+        // Enumerate the subsets of size k (records ranking above p)
+        std::vector<bool> below(m, false);
+        std::fill(below.begin(), below.begin() + k, true);
+        do {
+            for (int j = 0; j < m; ++j) {
+                const double sign = below[j] ? 1.0 : -1.0;
+                for (int d = 0; d < dims; ++d) A[j][d] = sign * coeffs[j][d];
+                A[j][dims] = 1.0;
+                b[j] = sign * knowns[j];
+            }
+            auto [x, fun, status, message] = linprog_highs(c, A, b, bounds);
+            if (!x.empty() && x[dims] > kEps && -fun > kEps) {
+                return dominators + k + 1;
+            }
+        } while (std::prev_permutation(below.begin(), below.end()));
+    }
+    return dominators + m + 1;
+}
+
+std::map<int, int> readReference(const std::filesystem::path& filename) {
+    std::map<int, int> ref;
+    std::ifstream in(filename);
+    std::string line;
+    std::getline(in, line); // header
+    while (std::getline(in, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        const size_t comma = line.find(',');
+        if (comma == std::string::npos) continue;
+        ref[std::stoi(line.substr(0, comma))] = std::stoi(line.substr(comma + 1));
+    }
+    return ref;
+}
+
+/**
+ * \brief Expected-mismatch baseline: key -> maxrank the engine is known to report.
+ *        Every entry must follow the '#' lines that justify it, returned in \p notes.
+ *        A missing file is an empty baseline.
+ */
+std::map<MismatchKey, int> readBaseline(const std::filesystem::path& filename,
+                                        std::map<MismatchKey, std::string>& notes) {
+    std::map<MismatchKey, int> expected;
+    std::ifstream in(filename);
+    std::string line;
+    std::string note;   // '#' lines since the column header or the last entry
+    bool header = false;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        if (line.rfind("dataset,", 0) == 0) {
+            header = true;
+            continue;
+        }
+        if (line[0] == '#') {
+            if (header) note += line + "\n";
+            continue;
+        }
+        if (note.empty()) throw std::invalid_argument("baseline entry without a justification: " + line);
+        // The engine flags are separated by ';' in the file (',' separates the columns)
+        std::stringstream ss(line);
+        std::string name, engine, level, capacity, id, maxrank;
+        if (!std::getline(ss, name, ',') || !std::getline(ss, engine, ',') || !std::getline(ss, level, ',') ||
+            !std::getline(ss, capacity, ',') || !std::getline(ss, id, ',') || !std::getline(ss, maxrank, ',')) {
+            throw std::invalid_argument("malformed baseline line: " + line);
+        }
+        std::replace(engine.begin(), engine.end(), ';', ',');
+        const MismatchKey key{name, engine, std::stoi(level), std::stoi(capacity), std::stoi(id)};
+        expected[key] = std::stoi(maxrank);
+        notes[key] = std::move(note);
+        note.clear();
+    }
+    return expected;
+}
+
+/**
+ * \brief Writes a baseline with the justification of every entry that has one in \p notes;
+ *        the others must be justified by hand before the file is read again.
+ */
+void writeBaselineFile(const std::string& filename, const std::map<MismatchKey, int>& mismatches,
+                       const std::map<MismatchKey, std::string>& notes) {
+    std::ofstream out(filename);
+    if (!out.is_open()) throw std::runtime_error("Could not open file: " + filename);
+    out << "# Known mismatches of aa_hd reported by maxrank_verify (regenerate with --write-baseline).\n"
+        << "# Each entry follows the '#' lines that say why it is not a bug of the engine.\n"
+        << "dataset,engine,maxLevelQTree,maxCapacityQNode,id,maxrank\n";
+    for (const auto& [key, maxrank] : mismatches) {
+        const auto note = notes.find(key);
+        if (note != notes.end()) out << note->second;
+        auto [name, engine, level, capacity, id] = key;
+        std::replace(engine.begin(), engine.end(), ',', ';');
+        out << name << "," << engine << "," << level << "," << capacity << "," << id << "," << maxrank << "\n";
+    }
+}
+
+std::vector<Dataset> loadExamples(const std::filesystem::path& dir) {
+    std::vector<Dataset> datasets;
+    if (!std::filesystem::is_directory(dir)) {
+        std::cerr << "Examples directory not found: " << dir << std::endl;
+        return datasets;
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+        if (!entry.is_directory()) continue;
+        const auto refFile = entry.path() / "ResultsBF250.csv";
+        if (!std::filesystem::exists(refFile)) continue;
+
+        for (const auto& file : std::filesystem::directory_iterator(entry.path())) {
+            if (file.path().filename().string().rfind("data_", 0) != 0) continue;
+
+            // Dimensions from the header, records from the line count
+            std::ifstream in(file.path());
+            std::string header, line;
+            std::getline(in, header);
+            const int dims = static_cast<int>(std::count(header.begin(), header.end(), ','));
+            int numRecords = 0;
+            while (std::getline(in, line)) numRecords += line.empty() ? 0 : 1;
+
+            Dataset ds;
+            ds.name = entry.path().filename().string();
+            ds.data = readCSV(file.path().string(), numRecords, dims);
+            ds.reference = readReference(refFile);
+            for (const auto& [id, rank] : ds.reference) ds.queries.push_back(id);
+            datasets.push_back(std::move(ds));
+        }
+    }
+    std::sort(datasets.begin(), datasets.end(), [](const Dataset& a, const Dataset& b) { return a.name < b.name; });
+    return datasets;
+}
+
+std::vector<Dataset> randomDatasets(const int count) {
+    std::vector<Dataset> datasets;
+    const Distribution dists[] = {Distribution::INDEPENDENT, Distribution::ANTICORRELATED, Distribution::CORRELATED};
+    for (int k = 0; k < count; ++k) {
+        const int dims = 3 + (k % 2);
+        const int n = 10 + 2 * (k % 3);
+        const Distribution dist = dists[k % 3];
+        Dataset ds;
+        ds.name = "random_" + distributionName(dist) + "_n" + std::to_string(n) + "_d" + std::to_string(dims);
+        ds.data = gendata(dist, n, dims, 1000 + k);
+        ds.queries.resize(n);
+        std::iota(ds.queries.begin(), ds.queries.end(), 1);
+        datasets.push_back(std::move(ds));
+    }
+    return datasets;
+}
+
+/**
+ * \brief DominanceIndex::partition against getpartition on independent, anticorrelated and
+ *        heavily tied (rounded to 0.1) data, sizes around the 64-bit words, with query points
+ *        taken from the data and drawn around and outside [0,1]^d.
+ * \return Number of query points whose partitions differ.
+ */
+int checkDominanceIndex(std::ostream& report) {
+    struct Case { Distribution dist; int n; int dims; bool tied; };
+    const Case cases[] = {
+        {Distribution::INDEPENDENT, 2000, 4, false},
+        {Distribution::ANTICORRELATED, 1037, 5, false},
+        {Distribution::INDEPENDENT, 1500, 3, true},
+        {Distribution::CORRELATED, 50, 6, true},
+        {Distribution::ANTICORRELATED, 64, 3, false},
+    };
+    int failures = 0;
+    unsigned int seed = 2000;
+    for (const auto& c : cases) {
+        std::vector<Point> data = gendata(c.dist, c.n, c.dims, seed++);
+        if (c.tied) {
+            for (auto& r : data) {
+                for (auto& v : r.coord) v = std::round(v * 10.0) / 10.0;
+            }
+        }
+        const DominanceIndex index(data);
+
+        std::vector<Point> queries;
+        for (size_t i = 0; i < data.size(); i += 7) queries.push_back(data[i]);
+        std::mt19937 gen(seed++);
+        std::uniform_real_distribution<double> around(-0.1, 1.1);
+        for (int k = 0; k < 100; ++k) {
+            std::vector<double> coord(c.dims);
+            for (auto& v : coord) v = c.tied ? std::round(around(gen) * 10.0) / 10.0 : around(gen);
+            queries.emplace_back(coord);
+        }
+
+        for (const auto& p : queries) {
+            const DominancePartition expected = getpartition(data, p);
+            DominancePartition got = index.partition(p);
+            std::vector<size_t> want = expected.incomparables;
+            std::sort(want.begin(), want.end());
+            std::sort(got.incomparables.begin(), got.incomparables.end());
+            if (got.dominators != expected.dominators || got.dominees != expected.dominees || got.incomparables != want) {
+                failures++;
+                report << "    " << distributionName(c.dist) << (c.tied ? " tied" : "") << " n=" << c.n
+                       << " d=" << c.dims << ": index has " << got.dominators << "/" << got.dominees << "/"
+                       << got.incomparables.size() << " dominators/dominees/incomparables, scan "
+                       << expected.dominators << "/" << expected.dominees << "/" << want.size() << "\n";
+            }
+        }
+    }
+    return failures;
+}
+
+/**
+ * \brief MbrBatch::classify against exactMbrPosition, box by box: 2 to 9 dimensions, batch
+ *        sizes around the 16 lanes, degenerate boxes, hyperplanes through box corners and
+ *        within rounding distance of them, zero, subnormal and huge coefficients. Both the
+ *        portable and, where the CPU has it, the AVX-512 path are checked.
+ * \return Number of (halfspace, box) pairs classified differently.
+ */
+int checkMbrBatch(std::ostream& report) {
+    std::mt19937 gen(4600);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    std::uniform_real_distribution<double> signedUnit(-1.0, 1.0);
+    const size_t batchSizes[] = {1, 15, 16, 17, 40};
+
+    const bool avx512 = MbrBatch::avx512();
+    std::vector<bool> paths = {false};
+    if (avx512) paths.push_back(true);
+
+    int failures = 0;
+    size_t pairs = 0;
+    for (int dims = 2; dims <= 9; ++dims) {
+        for (const size_t count : batchSizes) {
+            std::vector<std::vector<std::array<float, 2>>> boxes(count, std::vector<std::array<float, 2>>(dims));
+            for (auto& box : boxes) {
+                for (auto& range : box) {
+                    const float a = static_cast<float>(unit(gen));
+                    const float b = unit(gen) < 0.1 ? a : static_cast<float>(unit(gen));
+                    range = {std::min(a, b), std::max(a, b)};
+                }
+            }
+            const MbrBatch batch(boxes);
+            std::vector<PositionHS> got(count);
+
+            for (int h = 0; h < 1000; ++h) {
+                std::vector<double> coeff(dims);
+                const int kind = h % 5;
+                for (auto& c : coeff) {
+                    c = signedUnit(gen);
+                    if (kind == 2 && unit(gen) < 0.3) c = 0.0;
+                    if (kind == 3) c *= unit(gen) < 0.5 ? 1e-39 : 1e-20;
+                    if (kind == 4 && unit(gen) < 0.2) c *= 1e35;
+                }
+                // The hyperplane passes through a corner of one box, or just next to it
+                const auto& box = boxes[static_cast<size_t>(unit(gen) * count) % count];
+                double corner = 0.0;
+                for (int d = 0; d < dims; ++d) corner += coeff[d] * box[d][unit(gen) < 0.5 ? 0 : 1];
+                double known = corner;
+                if (kind == 1) known = std::nextafter(corner, unit(gen) < 0.5 ? -1e300 : 1e300);
+                if (kind == 2) known = corner * (1.0 + 1e-7 * signedUnit(gen));
+                if (kind == 0 && h % 10 == 0) known = signedUnit(gen) * dims;
+
+                for (const bool path : paths) {
+                    MbrBatch::setAvx512(path);
+                    batch.classify(coeff, known, got.data());
+                    for (size_t b = 0; b < count; ++b) {
+                        pairs++;
+                        const PositionHS expected = exactMbrPosition(coeff, known,
+                                                                     [&](const size_t d) { return boxes[b][d][0]; },
+                                                                     [&](const size_t d) { return boxes[b][d][1]; });
+                        if (got[b] != expected && failures++ < 10) {
+                            report << "    d=" << dims << " batch of " << count << ", box " << b << ", halfspace kind "
+                                   << kind << (path ? " (AVX-512)" : "") << ": batch " << static_cast<int>(got[b])
+                                   << ", exact " << static_cast<int>(expected) << "\n";
+                        }
+                    }
+                }
+            }
+        }
+    }
+    MbrBatch::setAvx512(avx512);
+    report << "    " << pairs << " (halfspace, box) pairs, " << (avx512 ? "portable and AVX-512 paths" : "portable path")
+           << "\n";
+    return failures;
+}
+
+/**
+ * \brief Exact 2D MaxRank of p over data whose coordinates are multiples of 1 / grid: the
+ *        intersections of the records' lines with p's are compared as fractions of integers,
+ *        and the rank is counted at the middle of every non-empty range of w1 between them.
+ */
+int exact2DMaxRank(const std::vector<Point>& data, const Point& p, const double grid) {
+    auto toGrid = [&](const double v) { return std::llround(v * grid); };
+    const long long px = toGrid(p.coord[0]);
+    const long long py = toGrid(p.coord[1]);
+
+    // Intersections num / den, den > 0, strictly inside (0, 1)
+    std::vector<std::pair<long long, long long>> cuts = {{0, 1}, {1, 1}};
+    for (const auto& r : data) {
+        long long num = toGrid(r.coord[1]) - py;
+        long long den = (px - py) - (toGrid(r.coord[0]) - toGrid(r.coord[1]));
+        if (den == 0) continue;
+        if (den < 0) {
+            num = -num;
+            den = -den;
+        }
+        if (num > 0 && num < den) cuts.emplace_back(num, den);
+    }
+    auto less = [](const auto& a, const auto& b) { return a.first * b.second < b.first * a.second; };
+    std::sort(cuts.begin(), cuts.end(), less);
+
+    long long best = static_cast<long long>(data.size()) + 1;
+    for (size_t i = 0; i + 1 < cuts.size(); ++i) {
+        if (!less(cuts[i], cuts[i + 1])) continue;
+        // w1 = num / den halfway between the two cuts; r scores lower iff w1 (rx - px) + (1 - w1) (ry - py) < 0
+        const long long num = cuts[i].first * cuts[i + 1].second + cuts[i + 1].first * cuts[i].second;
+        const long long den = 2 * cuts[i].second * cuts[i + 1].second;
+        long long below = 0;
+        for (const auto& r : data) {
+            below += num * (toGrid(r.coord[0]) - px) + (den - num) * (toGrid(r.coord[1]) - py) < 0 ? 1 : 0;
+        }
+        best = std::min(best, below + 1);
+    }
+    return static_cast<int>(best);
+}
+
+/**
+ * \brief aa_2d and the 2D batch engine (aa_2d_batch) against exact2DMaxRank on data rounded to
+ *        a coarse grid (many records tied with each other and lines crossing p's line in the
+ *        same point) and to a fine one; the rank at the middle of the first returned range of
+ *        w1 must also be the reported MaxRank.
+ * \return Number of queries on which an engine is wrong.
+ */
+int check2D(std::ostream& report) {
+    struct Case { Distribution dist; int n; double grid; };
+    const Case cases[] = {
+        {Distribution::INDEPENDENT, 300, 20.0},
+        {Distribution::ANTICORRELATED, 300, 20.0},
+        {Distribution::CORRELATED, 200, 20.0},
+        {Distribution::INDEPENDENT, 400, 1000.0},
+        {Distribution::ANTICORRELATED, 400, 1000.0},
+    };
+    int failures = 0;
+    size_t queries = 0;
+    unsigned int seed = 2600;
+    for (const auto& c : cases) {
+        std::vector<Point> data = gendata(c.dist, c.n, 2, seed++);
+        for (auto& r : data) {
+            for (auto& v : r.coord) v = std::round(v * c.grid) / c.grid;
+        }
+        std::vector<int> ids;
+        for (int id = 1; id <= c.n; id += 3) ids.push_back(id);
+        const std::vector<Result2D> batch = aa_2d_batch(data, ids);
+
+        for (size_t i = 0; i < ids.size(); ++i) {
+            const Point& p = data[ids[i] - 1];
+            const int truth = exact2DMaxRank(data, p, c.grid);
+            const auto [maxrank, intervals] = aa_2d(data, p);
+            queries++;
+
+            auto rankInRange = [&](const double from, const double to) {
+                const double w1 = (from + to) / 2.0;
+                return rankAt(data, p, {w1, 1.0 - w1});
+            };
+            std::ostringstream errors;
+            if (maxrank != truth) errors << "; aa_2d " << maxrank;
+            if (!intervals.empty() && rankInRange(intervals.front().range.first, intervals.front().range.second) != maxrank) {
+                errors << "; aa_2d range [" << intervals.front().range.first << ", "
+                       << intervals.front().range.second << "] has another rank";
+            }
+            if (batch[i].maxrank != truth) errors << "; batch " << batch[i].maxrank;
+            if (batch[i].ranges.empty() ||
+                rankInRange(batch[i].ranges.front().first, batch[i].ranges.front().second) != batch[i].maxrank) {
+                errors << "; batch range has another rank";
+            }
+            if (!errors.str().empty() && failures++ < 10) {
+                report << "    " << distributionName(c.dist) << " n=" << c.n << " grid 1/" << c.grid << ", id "
+                       << ids[i] << ": exact " << truth << errors.str() << "\n";
+            }
+        }
+    }
+    report << "    " << queries << " queries\n";
+    return failures;
+}
+
+/**
+ * \brief DynamicDataset under random inserts and deletes: after every update each tracked
+ *        result still fresh must equal a full recompute on the current records, and every
+ *        stale one must after refresh(). The update rules are checked on their own as well:
+ *        a dominator shifts the maxrank by one, an incomparable insert keeps only the witnesses
+ *        where p still scores strictly better (none in 2D, where the query always goes stale),
+ *        and an incomparable delete keeps the result only when maxrank == dominators + 1.
+ *        Runs without the memory budget of the run: degraded results are never maintained.
+ * \return Number of failed checks.
+ */
+int checkDynamic(std::ostream& report) {
+    const ScopedGlobal<int> noBudget(memoryBudget, 0);
+    int failures = 0;
+    auto fail = [&](const std::string& what) {
+        if (failures++ < 10) report << "    " << what << "\n";
+    };
+    auto dominates = [](const Point& r, const Point& p) {
+        bool less = false;
+        for (int d = 0; d < p.dims; ++d) {
+            if (r.coord[d] > p.coord[d]) return false;
+            less = less || r.coord[d] < p.coord[d];
+        }
+        return less;
+    };
+    auto incomparable = [&](const Point& r, const Point& p) {
+        return !dominates(r, p) && !dominates(p, r) && !(r == p);
+    };
+
+    for (const int dims : {3, 2}) {
+        std::mt19937 gen(3900 + dims);
+        std::uniform_real_distribution<double> unit(0.0, 1.0);
+        DynamicDataset dyn(gendata(Distribution::INDEPENDENT, dims == 2 ? 150 : 60, dims, 3900 + dims));
+        std::vector<int> ids;
+        for (int id = 1; id <= static_cast<int>(dyn.records().size()); id += 5) ids.push_back(id);
+        for (const int id : ids) dyn.query(id);
+
+        // Tracked results must match a recompute (skipped when the recompute itself is not exact)
+        auto compare = [&](const int id, const TrackedQuery& t, const std::string& when) {
+            const TrackedQuery truth = DynamicDataset::compute(dyn.records(), *dyn.record(id));
+            if (truth.budgetHit || queryMetrics.limitsHit > 0) return;
+            if (t.result.maxrank != truth.result.maxrank || t.dominators != truth.dominators) {
+                fail(std::to_string(dims) + "D id " + std::to_string(id) + " " + when + ": maxrank " +
+                     std::to_string(t.result.maxrank) + " (" + std::to_string(t.dominators) +
+                     " dominators), recomputed " + std::to_string(truth.result.maxrank) + " (" +
+                     std::to_string(truth.dominators) + ")");
+            }
+        };
+
+        long shifts = 0, insertKept = 0, insertStale = 0, deleteKept = 0, deleteStale = 0;
+        const int steps = dims == 2 ? 80 : 50;
+        for (int step = 0; step < steps; ++step) {
+            const int target = ids[std::uniform_int_distribution<size_t>(0, ids.size() - 1)(gen)];
+            const Point p = *dyn.record(target);
+            std::map<int, TrackedQuery> before;
+            for (const auto& [id, t] : dyn.tracked()) {
+                if (!t.stale) before.emplace(id, t);
+            }
+
+            // Insert a dominator, an incomparable or a dominated record of one tracked query,
+            // or delete a record (a tracked one now and then)
+            const int op = std::uniform_int_distribution<int>(0, 9)(gen);
+            std::optional<Point> changed;
+            bool inserted = op < 6;
+            if (inserted) {
+                std::vector<double> coord(dims);
+                do {
+                    for (int d = 0; d < dims; ++d) {
+                        const double u = unit(gen);
+                        coord[d] = op < 2 ? p.coord[d] * u : op < 5 ? u : p.coord[d] + (1.0 - p.coord[d]) * u;
+                    }
+                } while (op >= 2 && op < 5 && !incomparable(Point(coord), p));
+                changed = *dyn.record(dyn.insert(coord));
+            } else {
+                const auto& records = dyn.records();
+                int id = records[std::uniform_int_distribution<size_t>(0, records.size() - 1)(gen)].id;
+                const bool tracked = std::find(ids.begin(), ids.end(), id) != ids.end();
+                if (tracked && (op < 9 || ids.size() < 4)) continue;
+                changed = *dyn.record(id);
+                dyn.remove(id);
+                if (tracked) {
+                    ids.erase(std::find(ids.begin(), ids.end(), id));
+                    if (dyn.tracked().count(id)) fail("deleted record " + std::to_string(id) + " still tracked");
+                }
+            }
+            const Point& r = *changed;
+            const std::string when = std::string(inserted ? "after inserting " : "after deleting ") + std::to_string(r.id);
+
+            for (const auto& [id, old] : before) {
+                const auto it = dyn.tracked().find(id);
+                if (it == dyn.tracked().end()) continue;
+                const TrackedQuery& t = it->second;
+                const Point& q = *dyn.record(id);
+                if (dominates(r, q)) {
+                    shifts++;
+                    if (t.stale || t.result.maxrank != old.result.maxrank + (inserted ? 1 : -1)) {
+                        fail(std::to_string(dims) + "D id " + std::to_string(id) + " " + when + ": a dominator did not shift it");
+                    }
+                } else if (incomparable(r, q) && inserted) {
+                    (t.stale ? insertStale : insertKept)++;
+                    if (dims == 2 && !t.stale) fail("2D id " + std::to_string(id) + " " + when + ": kept without witnesses");
+                    for (const auto& w : t.witnesses) {
+                        double gap = 0.0;
+                        for (int d = 0; d < dims; ++d) gap += w[d] * (r.coord[d] - q.coord[d]);
+                        if (!(gap > 0.0)) fail(std::to_string(dims) + "D id " + std::to_string(id) + " " + when + ": kept a witness it beats");
+                    }
+                } else if (incomparable(r, q)) {
+                    (t.stale ? deleteStale : deleteKept)++;
+                    if (t.stale == (old.result.maxrank == old.dominators + 1)) {
+                        fail(std::to_string(dims) + "D id " + std::to_string(id) + " " + when +
+                             (t.stale ? ": stale at maxrank dominators + 1" : ": kept above dominators + 1"));
+                    }
+                } else if (t.stale) {
+                    fail(std::to_string(dims) + "D id " + std::to_string(id) + " " + when + ": stale after a dominated record");
+                }
+            }
+
+            for (const auto& [id, t] : dyn.tracked()) {
+                if (!t.stale) compare(id, t, when);
+            }
+            if (step % 10 == 9) {
+                dyn.refresh();
+                for (const auto& [id, t] : dyn.tracked()) compare(id, t, "after refresh");
+            }
+        }
+
+        report << "    " << dims << "D: " << dyn.stats().inserts << " inserts, " << dyn.stats().deletes << " deletes; "
+               << shifts << " dominator shifts, incomparable inserts " << insertKept << " kept / " << insertStale
+               << " stale, incomparable deletes " << deleteKept << " kept / " << deleteStale << " stale, "
+               << dyn.stats().recomputed << " recomputed\n";
+        // Every rule must have been exercised (in 2D an incomparable insert never keeps the result)
+        if (shifts == 0 || insertStale == 0 || deleteKept == 0 || deleteStale == 0 || (dims > 2 && insertKept == 0)) {
+            fail(std::to_string(dims) + "D: some update rule was never exercised");
+        }
+    }
+    return failures;
+}
+
+/**
+ * \brief reverseMaxRank against one full query per record (aa_hd in 3D, aa_2d in 2D) for
+ *        several k: the answer set must be exactly the records of MaxRank <= k, and each match
+ *        must report a rank between the MaxRank and k that it reaches at its witness (the very
+ *        rank for a sampled match, which is only an upper bound of the MaxRank).
+ * \return Number of failed checks.
+ */
+int checkReverse(std::ostream& report) {
+    int failures = 0;
+    auto fail = [&](const std::string& what) {
+        if (failures++ < 10) report << "    " << what << "\n";
+    };
+    for (const int dims : {3, 2}) {
+        const std::vector<Point> data = gendata(Distribution::ANTICORRELATED, dims == 2 ? 200 : 80, dims, 4300 + dims);
+        std::map<int, int> maxrank;
+        for (const auto& p : data) maxrank[p.id] = dims > 2 ? aa_hd(data, p).first : aa_2d(data, p).first;
+
+        for (const int k : {1, 3, 8}) {
+            ReverseStats stats;
+            const std::vector<ReverseMatch> matches = reverseMaxRank(data, k, &stats);
+            const std::string what = std::to_string(dims) + "D k=" + std::to_string(k);
+            std::set<int> answered;
+            size_t sampled = 0;
+            for (const auto& m : matches) {
+                answered.insert(m.id);
+                sampled += m.sampled ? 1 : 0;
+                const Point& p = data[m.id - 1];
+                const int atWitness = m.witness.empty() ? 0 : rankAt(data, p, m.witness);
+                if (m.rank < maxrank[m.id] || m.rank > k) {
+                    fail(what + " id " + std::to_string(m.id) + ": rank " + std::to_string(m.rank) +
+                         ", maxrank " + std::to_string(maxrank[m.id]));
+                } else if (m.sampled ? atWitness != m.rank : atWitness == 0 || atWitness > k) {
+                    fail(what + " id " + std::to_string(m.id) + ": rank " + std::to_string(atWitness) + " at the witness, reported " +
+                         std::to_string(m.rank));
+                }
+            }
+            for (const auto& [id, rank] : maxrank) {
+                if ((rank <= k) != (answered.count(id) > 0)) {
+                    fail(what + " id " + std::to_string(id) + ": maxrank " + std::to_string(rank) +
+                         (rank <= k ? " but not answered" : " but answered"));
+                }
+            }
+            if (stats.matches != matches.size() || stats.sampled != sampled || stats.sampled + stats.searched != stats.candidates) {
+                fail(what + ": inconsistent stats");
+            }
+            report << "    " << what << ": " << matches.size() << " matches, " << stats.sampled << " sampled ("
+                   << stats.hull << " ranked first), " << stats.searched << " searched of " << stats.candidates
+                   << " candidates\n";
+        }
+    }
+    return failures;
+}
+
+/**
+ * \brief Sets the engine options from MaxRankProject flags without the leading "--",
+ *        separated by ',' ("default" sets none).
+ */
+void applyEngineFlags(const std::string& engine) {
+    if (engine == "default") return;
+    std::vector<std::string> flags;
+    std::stringstream ss(engine);
+    std::string item;
+    while (std::getline(ss, item, ',')) flags.push_back("--" + item);
+    std::vector<char*> args;
+    for (auto& f : flags) args.push_back(f.data());
+    parseArgs(static_cast<int>(args.size()), args.data(), 0);
+}
+
+VerifyOptions parseVerifyArgs(const int argc, char* argv[]) {
+    VerifyOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eqPos = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eqPos == std::string::npos) {
+            std::cerr << "Ignoring unrecognized argument: " << arg << std::endl;
+            continue;
+        }
+        const std::string key = arg.substr(2, eqPos - 2);
+        const std::string val = arg.substr(eqPos + 1);
+        if (key == "examples") {
+            opt.examples = val;
+        } else if (key == "random") {
+            opt.randomDatasets = std::stoi(val);
+        } else if (key == "samples") {
+            opt.samples = std::stoi(val);
+        } else if (key == "baseline") {
+            opt.baseline = val;
+        } else if (key == "write-baseline") {
+            opt.writeBaseline = val;
+        } else if (key == "datasets") {
+            std::stringstream ss(val);
+            std::string item;
+            while (std::getline(ss, item, ',')) opt.datasets.push_back(item);
+        } else if (key == "decision") {
+            opt.decision = std::stoi(val) != 0;
+        } else if (key == "engine") {
+            opt.engine = val.empty() ? "default" : val;
+        } else if (key == "configs") {
+            opt.configs.clear();
+            std::stringstream ss(val);
+            std::string item;
+            while (std::getline(ss, item, ',')) {
+                const size_t colon = item.find(':');
+                if (colon == std::string::npos) throw std::invalid_argument("expected level:capacity, got " + item);
+                opt.configs.emplace_back(std::stoi(item.substr(0, colon)), std::stoi(item.substr(colon + 1)));
+            }
+        } else {
+            std::cerr << "Unknown parameter: --" << key << std::endl;
+        }
+    }
+    return opt;
+}
+
+} // namespace
+
+int main(const int argc, char* argv[]) {
+    VerifyOptions opt;
+    std::map<MismatchKey, int> expected;
+    std::map<MismatchKey, std::string> notes;
+    try {
+        opt = parseVerifyArgs(argc, argv);
+        expected = readBaseline(opt.baseline, notes);
+        applyEngineFlags(opt.engine);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid arguments: " << e.what() << std::endl;
+        return 1;
+    }
+
+    quietMode = 1;
+    std::vector<Dataset> datasets = loadExamples(opt.examples);
+    for (auto& ds : randomDatasets(opt.randomDatasets)) datasets.push_back(std::move(ds));
+    if (!opt.datasets.empty()) {
+        datasets.erase(std::remove_if(datasets.begin(), datasets.end(), [&](const Dataset& ds) {
+            return std::none_of(opt.datasets.begin(), opt.datasets.end(),
+                                [&](const std::string& prefix) { return ds.name.rfind(prefix, 0) == 0; });
+        }), datasets.end());
+    }
+
+    int failures = 0;
+    int known = 0;
+    int approximate = 0;   ///< Query runs cut short by the limits or the memory budget
+
+    std::ostringstream structureReport;
+    const int indexFailures = checkDominanceIndex(structureReport);
+    std::cout << (indexFailures == 0 ? "PASS " : "FAIL ") << "DominanceIndex vs getpartition, "
+              << indexFailures << " mismatches" << std::endl;
+    std::cout << structureReport.str();
+    failures += indexFailures;
+
+    structureReport.str("");
+    const int batchFailures = checkMbrBatch(structureReport);
+    std::cout << (batchFailures == 0 ? "PASS " : "FAIL ") << "MbrBatch vs exactMbrPosition, "
+              << batchFailures << " mismatches" << std::endl;
+    std::cout << structureReport.str();
+    failures += batchFailures;
+
+    structureReport.str("");
+    const int twoDFailures = check2D(structureReport);
+    std::cout << (twoDFailures == 0 ? "PASS " : "FAIL ") << "aa_2d and the 2D batch engine vs exact 2D MaxRank, "
+              << twoDFailures << " mismatches" << std::endl;
+    std::cout << structureReport.str();
+    failures += twoDFailures;
+
+    structureReport.str("");
+    const int dynamicFailures = checkDynamic(structureReport);
+    std::cout << (dynamicFailures == 0 ? "PASS " : "FAIL ") << "DynamicDataset updates vs full recompute, "
+              << dynamicFailures << " mismatches" << std::endl;
+    std::cout << structureReport.str();
+    failures += dynamicFailures;
+
+    structureReport.str("");
+    const int reverseFailures = checkReverse(structureReport);
+    std::cout << (reverseFailures == 0 ? "PASS " : "FAIL ") << "reverseMaxRank vs one query per record, "
+              << reverseFailures << " mismatches" << std::endl;
+    std::cout << structureReport.str();
+    failures += reverseFailures;
+
+    std::map<MismatchKey, int> mismatches;    ///< Every mismatch of this run, known or not
+    std::vector<MismatchKey> fixed;           ///< Baseline entries that no longer mismatch
+    int degradedQueries = 0;                  ///< Queries that reached memoryBudget
+    for (const auto& ds : datasets) {
+        const SamplingOracle sampler(ds.data, opt.samples, 42);
+        std::map<int, int> sampled, exact;
+        for (const int q : ds.queries) {
+            sampled[q] = sampler.bestRank(ds.data[q - 1]);
+            const int ex = exhaustiveMaxRank(ds.data, ds.data[q - 1]);
+            if (ex > 0) exact[q] = ex;
+        }
+
+        for (const auto& [level, capacity] : opt.configs) {
+            maxLevelQTree = level;
+            maxCapacityQNode = capacity;
+
+            int dsFailures = 0;
+            int dsKnown = 0;
+            int dsApproximate = 0;
+            double elapsed = 0.0;
+            std::ostringstream report;
+            for (const int q : ds.queries) {
+                const Point& p = ds.data[q - 1];
+
+                const auto start = std::chrono::high_resolution_clock::now();
+                auto [maxrank, mincells] = aa_hd(ds.data, p);
+                const std::chrono::duration<double> t = std::chrono::high_resolution_clock::now() - start;
+                elapsed += t.count();
+
+                // A query degraded by the memory budget or cut short by the search limits
+                // (halfspacesLengthLimit, maxNoBinStringToCheck) reports an upper bound
+                const bool degraded = queryMetrics.memoryBudgetHit;
+                const auto limitsHit = queryMetrics.limitsHit;
+                const bool truncated = limitsHit > 0;
+                if (degraded) degradedQueries++;
+                std::vector<std::string> errors;
+                std::vector<std::string> approximations;   // Upper-bound gaps of a degraded / truncated query
+                auto upperBoundGap = [&](const std::string& what) {
+                    (degraded || truncated ? approximations : errors).push_back(what);
+                };
+                if (maxrank > sampled[q]) upperBoundGap("sampled oracle found rank " + std::to_string(sampled[q]));
+                const auto ref = ds.reference.find(q);
+                if (ref != ds.reference.end() && maxrank > ref->second) {
+                    upperBoundGap("reference file has rank " + std::to_string(ref->second));
+                }
+                const auto ex = exact.find(q);
+                if (ex != exact.end() && maxrank < ex->second) {
+                    errors.push_back("exhaustive oracle has rank " + std::to_string(ex->second));
+                } else if (ex != exact.end() && maxrank > ex->second) {
+                    upperBoundGap("exhaustive oracle has rank " + std::to_string(ex->second));
+                }
+                if (!mincells.empty()) {
+                    std::vector<double> w = mincells.front().feasible_pnt.coord;
+                    w.push_back(1.0 - std::accumulate(w.begin(), w.end(), 0.0));
+                    const int witness = rankAt(ds.data, p, w);
+                    if (witness != maxrank) {
+                        errors.push_back("rank at witness weights is " + std::to_string(witness));
+                    }
+                }
+                if (opt.decision && !degraded) {
+                    const int truth = ex != exact.end() ? ex->second : maxrank;
+                    for (const int k : {truth - 1, truth}) {
+                        if (k <= 0) continue;
+                        const auto [bound, cells] = aa_hd(ds.data, p, k);
+                        const bool reachable = bound <= k;
+                        if (reachable != (truth <= k)) {
+                            // Only an upper bound if the truth is a truncated maxrank or the decision search
+                            // was cut short (it then falls back to the full, truncated, search)
+                            const bool inexact = (truncated && ex == exact.end()) || queryMetrics.limitsHit > 0;
+                            (inexact ? approximations : errors).push_back(
+                                "decision at rank " + std::to_string(k) + " answers " +
+                                (reachable ? "reachable" : "unreachable") + " (rank bound " + std::to_string(bound) + ")");
+                        } else if (reachable && !cells.empty()) {
+                            std::vector<double> w = cells.front().feasible_pnt.coord;
+                            w.push_back(1.0 - std::accumulate(w.begin(), w.end(), 0.0));
+                            const int witness = rankAt(ds.data, p, w);
+                            if (witness > k) {
+                                errors.push_back("decision at rank " + std::to_string(k) +
+                                                 " has rank " + std::to_string(witness) + " at its witness");
+                            }
+                        }
+                    }
+                }
+
+                if (!approximations.empty()) {
+                    // Not a pass: the query is reported as approximate, with the limit that made it so
+                    dsApproximate++;
+                    report << "    id " << q << ": maxrank " << maxrank << " approximate ("
+                           << (degraded ? "memory budget"
+                               : truncated ? "limits hit " + std::to_string(limitsHit) + " times"
+                                           : "decision search cut short by the limits")
+                           << ")";
+                    for (const auto& a : approximations) report << "; " << a;
+                    report << "\n";
+                }
+
+                const MismatchKey key{ds.name, opt.engine, level, capacity, q};
+                const auto baseline = expected.find(key);
+                if (errors.empty()) {
+                    if (baseline != expected.end()) fixed.push_back(key);
+                    continue;
+                }
+                mismatches[key] = maxrank;
+                if (baseline != expected.end() && maxrank <= baseline->second) {
+                    dsKnown++;
+                    if (maxrank < baseline->second) {
+                        report << "    id " << q << ": maxrank " << maxrank << ", improved from the baseline "
+                               << baseline->second << "\n";
+                    }
+                    continue;
+                }
+                dsFailures++;
+                report << "    id " << q << ": maxrank " << maxrank;
+                if (baseline != expected.end()) report << " (baseline " << baseline->second << ")";
+                for (const auto& e : errors) report << "; " << e;
+                report << "\n";
+            }
+
+            failures += dsFailures;
+            known += dsKnown;
+            approximate += dsApproximate;
+            std::cout << (dsFailures == 0 ? "PASS " : "FAIL ") << ds.name
+                      << " [maxLevelQTree=" << level << ", maxCapacityQNode=" << capacity
+                      << (opt.engine == "default" ? "" : ", " + opt.engine)
+                      << (opt.decision ? ", decision" : "") << "] "
+                      << ds.queries.size() << " queries, " << exact.size() << " exact, "
+                      << dsFailures << " mismatches, " << dsKnown << " known, " << dsApproximate << " approximate, "
+                      << elapsed << " s" << std::endl;
+            std::cout << report.str();
+        }
+    }
+
+    if (!fixed.empty()) {
+        std::cout << fixed.size() << " baseline mismatch(es) no longer occur:";
+        for (const auto& [name, engine, level, capacity, id] : fixed) {
+            std::cout << " " << name << "/" << level << ":" << capacity << "/" << id;
+        }
+        std::cout << "\nRegenerate " << opt.baseline.string() << " with --write-baseline." << std::endl;
+    }
+    if (!opt.writeBaseline.empty()) {
+        // Entries of the other engine option sets are kept as they are
+        std::map<MismatchKey, int> entries = mismatches;
+        for (const auto& [key, maxrank] : expected) {
+            if (std::get<1>(key) != opt.engine) entries.emplace(key, maxrank);
+        }
+        writeBaselineFile(opt.writeBaseline, entries, notes);
+        std::cout << mismatches.size() << " mismatch(es) written to " << opt.writeBaseline << std::endl;
+    }
+
+    if (memoryBudget > 0) {
+        std::cout << degradedQueries << " query run(s) reached the memory budget of " << memoryBudget << " MB" << std::endl;
+        if (degradedQueries == 0) failures++;
+    }
+
+    std::cout << (failures == 0 ? "All checks passed" : std::to_string(failures) + " mismatch(es)")
+              << " (" << known << " known, " << approximate << " approximate)." << std::endl;
+    return failures == 0 ? 0 : 1;
+}
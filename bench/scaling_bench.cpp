@@ -0,0 +1,203 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "batch2d.h"
+#include "config.h"
+#include "csvutils.h"
+#include "datagen.h"
+#include "maxrank.h"
+#include "metrics.h"
+#include "utils.h"
+
+/**
+ * End-to-end scaling benchmark.
+ *
+ * For every (distribution, n, d) of the grid a synthetic dataset and a query file are
+ * generated in the regular input format (and kept in --outdir, so that a run can be
+ * reproduced with the main executable). The full pipeline (load + queries) is then run
+ * for every (maxLevelQTree, maxCapacityQNode, threads) combination, and one CSV row with
+ * per-phase times and peak memory is written per grid point.
+ *
+ * Usage: maxrank_scaling --outdir=<dir> [--out=scaling.csv] [--dist=ind,cor,anti]
+ *                        [--n=1000,10000] [--d=3,4] [--max-level-qtree=5]
+ *                        [--max-capacity-qnode=20] [--threads=0] [--queries=10]
+ *                        [--seed=42] [--config=<config file>]
+ * Every list flag accepts comma-separated values; the grid is their cartesian product.
+ */
+
+namespace {
+
+struct ScalingOptions {
+    std::string outdir;
+    std::string outFile = "scaling.csv";
+    std::string configFile;
+    std::vector<std::string> dists = {"ind"};
+    std::vector<int> ns = {1000};
+    std::vector<int> ds = {3};
+    std::vector<int> levels = {5};
+    std::vector<int> capacities = {20};
+    std::vector<int> threads = {0};
+    int queries = 10;
+    unsigned int seed = 42;
+};
+
+std::vector<std::string> splitList(const std::string& val) {
+    std::vector<std::string> out;
+    std::stringstream ss(val);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) out.push_back(item);
+    }
+    return out;
+}
+
+std::vector<int> splitIntList(const std::string& val) {
+    std::vector<int> out;
+    for (const auto& item : splitList(val)) {
+        out.push_back(std::stoi(item));
+    }
+    return out;
+}
+
+ScalingOptions parseScalingArgs(const int argc, char* argv[]) {
+    ScalingOptions opt;
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        const size_t eqPos = arg.find('=');
+        if (arg.rfind("--", 0) != 0 || eqPos == std::string::npos) {
+            std::cerr << "Ignoring unrecognized argument: " << arg << std::endl;
+            continue;
+        }
+        const std::string key = arg.substr(2, eqPos - 2);
+        const std::string val = arg.substr(eqPos + 1);
+        if (key == "outdir") opt.outdir = val;
+        else if (key == "out") opt.outFile = val;
+        else if (key == "config") opt.configFile = val;
+        else if (key == "dist") opt.dists = splitList(val);
+        else if (key == "n") opt.ns = splitIntList(val);
+        else if (key == "d") opt.ds = splitIntList(val);
+        else if (key == "max-level-qtree") opt.levels = splitIntList(val);
+        else if (key == "max-capacity-qnode") opt.capacities = splitIntList(val);
+        else if (key == "threads") opt.threads = splitIntList(val);
+        else if (key == "queries") opt.queries = std::stoi(val);
+        else if (key == "seed") opt.seed = static_cast<unsigned int>(std::stoul(val));
+        else std::cerr << "Unknown parameter: --" << key << std::endl;
+    }
+    if (opt.outdir.empty()) {
+        throw std::invalid_argument("--outdir is required");
+    }
+    return opt;
+}
+
+double secondsSince(const std::chrono::high_resolution_clock::time_point& start) {
+    const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    return elapsed.count();
+}
+
+} // namespace
+
+int main(const int argc, char* argv[]) {
+    ScalingOptions opt;
+    try {
+        opt = parseScalingArgs(argc, argv);
+        if (!opt.configFile.empty()) parseConfigFile(opt.configFile);
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid arguments: " << e.what() << std::endl;
+        return 1;
+    }
+    std::filesystem::create_directories(opt.outdir);
+    quietMode = 1;
+
+    std::ofstream out(opt.outFile);
+    if (!out.is_open()) {
+        std::cerr << "Could not open output file: " << opt.outFile << std::endl;
+        return 1;
+    }
+    out << "dist,n,d,maxLevelQTree,maxCapacityQNode,threads,queries,"
+           "gen_s,load_s,query_total_s,query_mean_s,query_max_s,skyline_s,insert_s,lp_s,lps_solved,"
+           "mean_maxrank,peak_rss_mb\n";
+
+    for (const auto& distName : opt.dists) {
+        const Distribution dist = parseDistribution(distName);
+        for (const int n : opt.ns) {
+            for (const int d : opt.ds) {
+                // 1) Generate dataset and query file in the regular input format
+                auto start = std::chrono::high_resolution_clock::now();
+                const std::vector<Point> generated = gendata(dist, n, d, opt.seed);
+                std::mt19937 gen(opt.seed);
+                std::uniform_int_distribution<int> pick(1, n);
+                std::vector<int> queryIds(opt.queries);
+                for (auto& q : queryIds) q = pick(gen);
+
+                const std::string stem = distributionName(dist) + "_n" + std::to_string(n) +
+                                         "_d" + std::to_string(d) + "_s" + std::to_string(opt.seed);
+                const std::string datafile  = (std::filesystem::path(opt.outdir) / ("data_" + stem + ".csv")).string();
+                const std::string queryfile = (std::filesystem::path(opt.outdir) / ("queries_" + stem + ".txt")).string();
+                writeDataCSV(datafile, generated);
+                writeQuery(queryfile, queryIds);
+                const double genTime = secondsSince(start);
+
+                for (const int level : opt.levels) {
+                    for (const int capacity : opt.capacities) {
+                        for (const int nthreads : opt.threads) {
+                            maxLevelQTree = level;
+                            maxCapacityQNode = capacity;
+                            numThreads = nthreads;
+                            resetPeakMemory();
+
+                            // 2) Load, as main does
+                            start = std::chrono::high_resolution_clock::now();
+                            const std::vector<Point> data = readCSV(datafile, n, d);
+                            const std::vector<int> query = readQuery(queryfile, opt.queries);
+                            const double loadTime = secondsSince(start);
+
+                            // 3) Queries
+                            double totalTime = 0.0, maxTime = 0.0, sumRank = 0.0;
+                            QueryMetrics phases;  // per-phase totals over the queries
+                            if (d == 2) {
+                                start = std::chrono::high_resolution_clock::now();
+                                for (const auto& r : aa_2d_batch(data, query)) sumRank += r.maxrank;
+                                totalTime = secondsSince(start);
+                                maxTime = totalTime;
+                            } else {
+                                for (const int q : query) {
+                                    start = std::chrono::high_resolution_clock::now();
+                                    sumRank += aa_hd(data, data[q - 1]).first;
+                                    const double t = secondsSince(start);
+                                    totalTime += t;
+                                    maxTime = std::max(maxTime, t);
+                                    phases.skylineTime += queryMetrics.skylineTime;
+                                    phases.insertTime += queryMetrics.insertTime;
+                                    phases.lpTime += queryMetrics.lpTime;
+                                    phases.lpsSolved += queryMetrics.lpsSolved;
+                                }
+                            }
+
+                            const double peakMB = static_cast<double>(getPeakMemory()) / (1024.0 * 1024.0);
+                            out << distributionName(dist) << "," << n << "," << d << "," << level << ","
+                                << capacity << "," << workerThreads() << "," << query.size() << ","
+                                << genTime << "," << loadTime << "," << totalTime << ","
+                                << totalTime / static_cast<double>(query.size()) << "," << maxTime << ","
+                                << phases.skylineTime << "," << phases.insertTime << "," << phases.lpTime << ","
+                                << phases.lpsSolved << ","
+                                << sumRank / static_cast<double>(query.size()) << "," << peakMB << "\n";
+                            out.flush();
+
+                            std::cerr << stem << " level=" << level << " capacity=" << capacity
+                                      << " threads=" << workerThreads() << ": " << totalTime
+                                      << " s, peak " << peakMB << " MB" << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    std::cerr << "Results written to " << opt.outFile << std::endl;
+    return 0;
+}
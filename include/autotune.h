@@ -0,0 +1,93 @@
+#ifndef AUTOTUNE_H
+#define AUTOTUNE_H
+
+#include <string>
+#include <vector>
+#include "geom.h"
+
+/**
+ * \struct TuneConfig
+ * \brief One candidate assignment of the tunable parameters.
+ */
+struct TuneConfig {
+    int maxCapacityQNode;
+    int maxLevelQTree;
+    int limitHamWeight;
+    int halfspacesLengthLimit;
+};
+
+/**
+ * \struct TuneTrial
+ * \brief Outcome of running one candidate on one rung of the search.
+ */
+struct TuneTrial {
+    int rung;               ///< Successive-halving rung (0 = smallest sample)
+    TuneConfig config;      ///< Candidate evaluated
+    int queries;            ///< Sample size of the rung
+    double time;            ///< Total seconds spent on the sample
+    long limitsHit;         ///< Leaf searches cut short by the limits (QueryMetrics::limitsHit)
+    int mismatches;         ///< Queries that hit a limit or whose maxrank differs from the reference
+    bool timedOut;          ///< Abandoned for taking longer than timeFactor x the fastest candidate
+};
+
+/**
+ * \brief Default candidate grid for a dataset of the given dimensionality.
+ *
+ * Deeper trees are only tried in low dimensions: every split creates 2^(dims-1) children.
+ * \param dims Dimensions of the dataset.
+ */
+std::vector<TuneConfig> autotuneGrid(int dims);
+
+/**
+ * \brief Successive-halving search of the fastest exact configuration.
+ *
+ * Every rung runs all the remaining candidates on the same query sample (drawn from
+ * \p queries), ranks them by (inexact queries, time) and keeps the best third; the sample
+ * grows three-fold at every rung. A candidate is exact on a query if it hit no limit there
+ * (QueryMetrics::limitsHit) and its maxrank equals the best one found by the candidates that
+ * hit no limit: rank that is only reached by a finer tree is never traded for speed, and
+ * truncated searches, which can report unreachable ranks, never win on accuracy.
+ *
+ * Candidates are run small leaves / deep trees / loose limits first, and a candidate is
+ * abandoned (through queryTimeLimit) once it has taken \p timeFactor times the total of the
+ * fastest candidate of the rung that hit no limit, so that exploding configurations cost a
+ * bounded amount of time. The global parameters, quietMode and queryTimeLimit are restored
+ * on return, and also when a query throws.
+ *
+ * \param data        The dataset.
+ * \param queries     1-based indices of the candidate query records.
+ * \param grid        Candidates (e.g. autotuneGrid()).
+ * \param sampleSize  Queries in the first rung.
+ * \param seed        Seed of the query sampling.
+ * \param timeFactor  Time allowed to a candidate, relative to the fastest one of the rung.
+ * \param trials      Receives one TuneTrial per candidate and rung.
+ * \return The best candidate.
+ */
+TuneConfig autotune(const std::vector<Point>& data,
+                    const std::vector<int>& queries,
+                    const std::vector<TuneConfig>& grid,
+                    int sampleSize,
+                    unsigned int seed,
+                    double timeFactor,
+                    std::vector<TuneTrial>& trials);
+
+/**
+ * \brief Path of the tuned configuration of a dataset: "<data stem>_tuned_config.txt"
+ *        in the directory of the dataset.
+ */
+std::string tunedConfigPath(const std::string& datafile);
+
+/**
+ * \brief Writes a configuration file (key=value lines, readable by parseConfigFile).
+ * \param filename Path to the output file.
+ * \param config   Parameters to write.
+ * \param comment  Provenance written as '#' comment lines at the top.
+ */
+void writeTunedConfig(const std::string& filename, const TuneConfig& config, const std::string& comment);
+
+/**
+ * \brief Writes every trial of a tuning run as CSV (one row per candidate and rung).
+ */
+void writeTuneTrialsCSV(const std::string& filename, const std::vector<TuneTrial>& trials);
+
+#endif // AUTOTUNE_H
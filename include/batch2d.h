@@ -0,0 +1,67 @@
+#ifndef BATCH2D_H
+#define BATCH2D_H
+
+#include <utility>
+#include <vector>
+#include "geom.h"
+
+/**
+ * \struct Result2D
+ * \brief Outcome of a 2D MaxRank query answered by the batch engine.
+ */
+struct Result2D {
+    int maxrank;                                    ///< Best rank reachable by the query record
+    std::vector<std::pair<double, double>> ranges;  ///< Weight intervals [w1 range] where the best rank holds
+};
+
+/**
+ * \class Batch2DEngine
+ * \brief Answers the 2D MaxRank queries of a batch from one contiguous copy of the data
+ *        (option sweep2D). A convenience wrapper around a per-query sweep, not a structure
+ *        shared by the queries.
+ *
+ * Every record r is read as the line y = m*x + q (m = r.x - r.y, q = r.y), exactly as
+ * HalfLine does. Coordinates are kept in structure-of-arrays form, so a query is a linear
+ * pass over contiguous memory instead of rebuilding skylines and halflines.
+ *
+ * Nothing else is shared between queries: the intersections of the lines with the query's
+ * line depend on the query, so every query builds O(n) events and sorts them, O(n log n) per
+ * query and O(Q n log n) for a batch of Q queries.
+ */
+class Batch2DEngine {
+public:
+    /**
+     * \brief Copies the coordinates of the given 2D dataset.
+     * \param data The dataset (every point must have 2 coordinates).
+     */
+    explicit Batch2DEngine(const std::vector<Point>& data);
+
+    /**
+     * \brief Answers a single MaxRank query, in O(n log n).
+     * \param p      The query point (2D).
+     * \param events Scratch buffer reused across calls by the same thread.
+     * \return The best rank of \p p and the intervals of w1 in which it is reached.
+     */
+    Result2D query(const Point& p, std::vector<std::pair<double, int>>& events) const;
+
+    /**
+     * \brief Number of records of the dataset.
+     */
+    [[nodiscard]] size_t size() const { return xs.size(); }
+
+private:
+    std::vector<double> xs;  ///< First coordinate of each record
+    std::vector<double> ys;  ///< Second coordinate of each record
+};
+
+/**
+ * \brief Batch MaxRank for 2D datasets: copies the data once and answers every query
+ *        from it, spreading the queries over the available hardware threads.
+ * \param data    The dataset (2D).
+ * \param queries 1-based indices of the query records in \p data.
+ * \return One Result2D per query, in the same order as \p queries.
+ */
+std::vector<Result2D> aa_2d_batch(const std::vector<Point>& data,
+                                  const std::vector<int>& queries);
+
+#endif // BATCH2D_H
@@ -7,6 +7,7 @@
 #include <string>
 #include <array>
 #include <memory>
+#include <tuple>
 #include "geom.h"
 #include "halfspace.h"
 #include "qnode.h"
@@ -36,9 +37,15 @@ public:
          const std::vector<std::array<float, 2>>& leaf_mbr,
          Point  feasible_pnt);
 
+    /**
+     * \brief Halfspaces covering this cell: those covering its leaf, plus the leaf's
+     *        overlapping halfspaces set to '1' in the mask.
+     */
+    [[nodiscard]] std::vector<long> coveringHalfspaces() const;
+
     /**
      * \brief Checks if all halfspaces covering this cell are marked as SINGULAR.
-     * \return True if every halfspace in 'covered' has Arrangement::SINGULAR.
+     * \return True if every halfspace in coveringHalfspaces() has Arrangement::SINGULAR.
      */
     [[nodiscard]] bool issingular() const;
 
@@ -91,6 +98,45 @@ struct Interval {
  */
 std::vector<std::string> genhammingstrings(int strlen, int weight);
 
+/**
+ * \class HammingStrings
+ * \brief The Hamming strings of genhammingstrings(), in the same order, produced a chunk
+ *        at a time instead of all at once (lean leaf search of a query over memoryBudget).
+ */
+class HammingStrings {
+public:
+    /**
+     * \brief Prepares the strings of genhammingstrings(strlen, weight).
+     */
+    HammingStrings(int strlen, int weight);
+
+    /**
+     * \brief Replaces \p out with the next (at most) \p count strings.
+     * \return False if no string was left.
+     */
+    bool next(std::vector<std::string>& out, size_t count);
+
+private:
+    int strlen;
+    bool invert;
+    bool done;
+    std::vector<int> ones;  ///< Positions of the '1' bits of the next string (before inversion)
+};
+
+/**
+ * \brief Solves min c^T x subject to A_ub x <= b_ub and the given bounds with HiGHS.
+ * \param c      Objective coefficients.
+ * \param A_ub   Constraint matrix (one row per constraint).
+ * \param b_ub   Right-hand sides of the constraints.
+ * \param bounds [lower, upper] bound of each variable.
+ * \return Tuple (solution, objective value, HighsModelStatus as int, status message).
+ */
+std::tuple<std::vector<double>, double, int, std::string>
+linprog_highs(const std::vector<double>& c,
+              const std::vector<std::vector<double>>& A_ub,
+              const std::vector<double>& b_ub,
+              const std::vector<std::pair<double, double>>& bounds);
+
 /**
  * \brief Searches for minimal cells using linear programming.
  * \param leaf        A reference to a QNode (leaf) with bounding MBR and halfspaces.
@@ -100,4 +146,16 @@ std::vector<std::string> genhammingstrings(int strlen, int weight);
 std::vector<Cell> searchmincells_lp(const QNode& leaf,
                                     const std::vector<std::string>& hamstrings);
 
+/**
+ * \brief Same search as searchmincells_lp(leaf, genhammingstrings(n, weight)), with n the
+ *        leaf's halfspaces, but the strings are generated in chunks: only the strings
+ *        tried are generated, one chunk at a time.
+ * \param leaf      A reference to a QNode (leaf) with bounding MBR and halfspaces.
+ * \param weight    Hamming weight of the strings.
+ * \param generated Set to the strings generated: above maxNoBinStringToCheck if the
+ *                  search stopped at that limit.
+ * \return A list of Cell objects that pass the feasibility check.
+ */
+std::vector<Cell> searchmincells_lp_chunked(const QNode& leaf, int weight, size_t& generated);
+
 #endif // CELL_H
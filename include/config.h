@@ -0,0 +1,77 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <string>
+
+/**
+ * \brief Global configurable parameters (defaults in config.cpp).
+ */
+extern int limitHamWeight;         ///< Max Hamming weight to consider
+extern int maxLevelQTree;          ///< Maximum allowed QTree depth
+extern int maxCapacityQNode;       ///< Maximum capacity of halfspaces in a QNode
+extern int qtreeSplit;             ///< QNode split: 0 = 2^dims halves, 1 = binary on the widest side, 2 = binary cutting fewest halfspaces
+extern int splitPosition;          ///< QNode cut position: 0 = midpoint, 1 = the candidate cut balancing the halfspaces of the two parts
+extern int maxNoBinStringToCheck;  ///< Maximum number of binary strings to check
+extern int halfspacesLengthLimit;  ///< Maximum number of halfspaces enumerated per leaf
+extern int sweep2D;                ///< If non-zero, 2D queries are answered by aa_2d_batch (a per-query sweep)
+extern int numThreads;             ///< Worker threads for parallel phases (0 = hardware concurrency)
+extern int quietMode;              ///< If non-zero, no per-query / per-iteration console output
+extern int perfCounters;           ///< If non-zero, sample hardware counters per query phase (Linux)
+extern int autotuneMode;           ///< If non-zero, tune the QTree / search limits on a query sample first
+extern int autotuneSample;         ///< Queries in the first rung of the autotune search
+extern int useTunedConfig;         ///< If non-zero, load "<data>_tuned_config.txt" when present
+extern int explainMode;            ///< If non-zero, dump QTree shape / leaf search statistics per expansion cycle
+extern std::string resultCacheDir; ///< Directory of the persistent result cache (empty = disabled)
+extern int rankThreshold;          ///< If positive, only decide whether each query can reach rank <= rankThreshold
+extern int boundSamples;           ///< Random weight vectors sampled for the upper bound that seeds the pruning (0 = off)
+extern int dominanceIndex;         ///< If non-zero, runs of dominanceIndexMinQueries or more queries build a bitmap dominance index first
+extern int resumeMode;             ///< If non-zero, continue the output files of an interrupted run
+extern int flushEvery;             ///< Result rows buffered before the output files are flushed
+extern int memoryBudget;           ///< Memory budget of a query in MB: close to it the query degrades (0 = none)
+extern std::string serverSocket;   ///< Unix socket of maxrank_server (empty = stdin / stdout protocol)
+extern int serverWorkers;          ///< Connections served concurrently by maxrank_server
+extern int serverQueue;            ///< Connections allowed to wait for a maxrank_server worker
+
+/**
+ * \brief Number of worker threads to use in the parallel phases.
+ * \return numThreads if set, otherwise the hardware concurrency (at least 1).
+ */
+unsigned int workerThreads();
+
+/**
+ * \brief Parses command-line flags of the form --flag=value
+ *        and updates the global variables accordingly.
+ *
+ * \param argc      Number of CLI arguments
+ * \param argv      Array of argument strings
+ * \param firstFlag Index of the first optional flag (after the positional parameters)
+ */
+void parseArgs(int argc, char* argv[], int firstFlag = 7);
+
+/**
+ * \brief (Optional) Reads a config file to set the global parameters.
+ *        Format: Each line as key=value (like limitHamWeight=999).
+ *
+ * \param configFile Path to the configuration file.
+ */
+void parseConfigFile(const std::string& configFile);
+
+/**
+ * \brief Overrides a global for a scope and restores its value on exit (return or throw).
+ */
+template <typename T>
+class ScopedGlobal {
+public:
+    explicit ScopedGlobal(T& target) : target(target), saved(target) {}
+    ScopedGlobal(T& target, T value) : target(target), saved(target) { target = value; }
+    ~ScopedGlobal() { target = saved; }
+
+    ScopedGlobal(const ScopedGlobal&) = delete;
+    ScopedGlobal& operator=(const ScopedGlobal&) = delete;
+
+private:
+    T& target;
+    T saved;
+};
+
+#endif // CONFIG_H
@@ -1,6 +1,9 @@
 #ifndef CSVUTILS_H
 #define CSVUTILS_H
 
+#include <chrono>
+#include <fstream>
+#include <unordered_set>
 #include "geom.h"
 
 /**
@@ -21,6 +24,20 @@ std::vector<Point> readCSV(const std::string& filename, int numRecords, int dime
  */
 std::vector<int> readQuery(const std::string& filename, int numQueries);
 
+/**
+ * Writes a dataset in the format read by readCSV (header, then id and coordinates per row).
+ * @param filename   Path to the CSV file.
+ * @param data       Records to write (their id is written as first column).
+ */
+void writeDataCSV(const std::string& filename, const std::vector<Point>& data);
+
+/**
+ * Writes a query file in the format read by readQuery (one index per line).
+ * @param filename   Path to the file.
+ * @param query      Query indices (1-based).
+ */
+void writeQuery(const std::string& filename, const std::vector<int>& query);
+
 /**
  * Writes data to a CSV file, supporting both int and double types.
  * @tparam T         Data type (int or double).
@@ -31,4 +48,73 @@ std::vector<int> readQuery(const std::string& filename, int numQueries);
 template <typename T>
 void writeCSV(const std::string& filename, const std::vector<std::vector<T>>& data, const std::vector<std::string>& headers);
 
+/**
+ * Streams rows to a CSV file with the layout of writeCSV, flushing them to disk in batches:
+ * every flushEvery rows, and at the first row written more than 30 seconds after the last
+ * flush (so that results of slow queries are not held back). The destructor flushes.
+ */
+class CSVStreamWriter {
+public:
+    /**
+     * @param filename   Path to the output file.
+     * @param headers    Column headers, written unless an existing file is continued.
+     * @param append     Continue an existing file instead of truncating it.
+     * @param flushEvery Rows buffered before a flush.
+     */
+    CSVStreamWriter(const std::string& filename, const std::vector<std::string>& headers, bool append, int flushEvery);
+    ~CSVStreamWriter() { flush(); }
+
+    /**
+     * Writes one row (doubles with 15 fixed decimals, as writeCSV).
+     */
+    template <typename T>
+    void writeRow(const std::vector<T>& row) {
+        if (row.empty()) return;
+        file << row[0];
+        for (size_t j = 1; j < row.size(); ++j) {
+            file << "," << row[j];
+        }
+        file << "\n";
+        if (++pending >= flushEvery ||
+            std::chrono::steady_clock::now() - lastFlush > std::chrono::seconds(30)) {
+            flush();
+        }
+    }
+
+    /**
+     * Pushes the buffered rows to the file.
+     */
+    void flush();
+
+private:
+    std::ofstream file;
+    int flushEvery;
+    int pending = 0;
+    std::chrono::steady_clock::time_point lastFlush;
+};
+
+/**
+ * Prepares the maxrank and cells files of an interrupted run to be continued: keeps the rows
+ * of the ids that are complete (newline-terminated) in both files, drops the others (a line
+ * torn by the crash, a maxrank row whose cells row was never written) and rewrites the files
+ * with those rows only. Missing files are created with their header.
+ * @param maxrankFile    Path to the maxrank file.
+ * @param cellsFile      Path to the cells file.
+ * @param maxrankHeaders Header of the maxrank file.
+ * @param cellsHeaders   Header of the cells file.
+ * @return Ids of the queries already done.
+ */
+std::unordered_set<int> resumeResultCSVs(const std::string& maxrankFile, const std::string& cellsFile,
+                                         const std::vector<std::string>& maxrankHeaders,
+                                         const std::vector<std::string>& cellsHeaders);
+
+/**
+ * Drops from a per-query file of an interrupted run (metrics, memory) the rows of the queries
+ * that are not done, i.e. that the resumed run computes again, and the line torn by the crash.
+ * Its header is kept; a missing file is left missing.
+ * @param filename Path to the file (first column: query id).
+ * @param done     Ids of the queries already done, as returned by resumeResultCSVs().
+ */
+void resumeQueryCSV(const std::string& filename, const std::unordered_set<int>& done);
+
 #endif //CSVUTILS_H
@@ -0,0 +1,40 @@
+#ifndef DATAGEN_H
+#define DATAGEN_H
+
+#include <string>
+#include <vector>
+#include "geom.h"
+
+/**
+ * \enum Distribution
+ * \brief Synthetic data distributions used by the benchmark tools.
+ */
+enum class Distribution {
+    INDEPENDENT,    ///< Attributes drawn uniformly and independently in [0,1]
+    CORRELATED,     ///< Records close to the diagonal: good in one attribute, good in all
+    ANTICORRELATED  ///< Records close to the plane sum(x) = dims/2: good in one, bad in others
+};
+
+/**
+ * \brief Parses a distribution name ("independent", "correlated", "anticorrelated").
+ * \param name The distribution name (the short forms "ind", "cor", "anti" are accepted too).
+ * \return The matching Distribution; throws std::invalid_argument if unknown.
+ */
+Distribution parseDistribution(const std::string& name);
+
+/**
+ * \brief Short name of a distribution, as used in generated file names.
+ */
+std::string distributionName(Distribution dist);
+
+/**
+ * \brief Generates a synthetic dataset with coordinates in [0,1].
+ * \param dist       Data distribution.
+ * \param numRecords Number of records to generate (IDs are 1..numRecords).
+ * \param dims       Number of dimensions.
+ * \param seed       Seed of the random generator (same seed => same dataset).
+ * \return Vector of generated Points.
+ */
+std::vector<Point> gendata(Distribution dist, int numRecords, int dims, unsigned int seed);
+
+#endif // DATAGEN_H
@@ -0,0 +1,72 @@
+#ifndef DOMINANCEINDEX_H
+#define DOMINANCEINDEX_H
+
+#include <cstdint>
+#include <vector>
+#include "geom.h"
+#include "query.h"
+
+/**
+ * \class DominanceIndex
+ * \brief Dataset-level bit-sliced index answering getpartition() without scanning every record.
+ *
+ * Each dimension is cut into up to 64 quantile buckets (equal values share a bucket), and
+ * for every bucket b the index keeps the bitmap of the records in buckets <= b. For a query
+ * point p in bucket b_d of dimension d, the records below b_d are strictly smaller and the
+ * records above it strictly greater in that dimension, so AND / OR / popcount over 64-bit
+ * words settle the dominators, dominees and incomparables; only the records that share p's
+ * bucket in some dimension, and are not already known to be incomparable, are compared
+ * coordinate by coordinate.
+ *
+ * Memory: dims * buckets * numRecords bits (about 40 MB for a million 5D records).
+ */
+class DominanceIndex {
+public:
+    explicit DominanceIndex(const std::vector<Point>& data);
+
+    /**
+     * \brief True if the index was built on this very dataset (same object, same size).
+     */
+    [[nodiscard]] bool covers(const std::vector<Point>& data) const {
+        return &data == source && data.size() == n;
+    }
+
+    /**
+     * \brief Same result as getpartition(data, p) for the indexed dataset.
+     */
+    [[nodiscard]] DominancePartition partition(const Point& p) const;
+
+    /**
+     * \brief Bytes held by the bitmaps and bucket bounds.
+     */
+    [[nodiscard]] size_t bytes() const;
+
+private:
+    const std::vector<Point>* source;
+    size_t n;
+    size_t words;
+    int dims;
+    std::vector<std::vector<double>> lower;                 ///< lower[d][b]: smallest value of bucket b
+    std::vector<std::vector<std::vector<uint64_t>>> upTo;   ///< upTo[d][b]: records in buckets <= b
+};
+
+/**
+ * \brief Queries a run needs before building the index pays off. On 1M x 5D independent
+ *        data the build costs about 38 scans (0.87 s) and a partition saves about 9 ms over
+ *        the 23 ms scan, so fewer queries are answered faster by scanning.
+ */
+constexpr size_t dominanceIndexMinQueries = 100;
+
+/**
+ * \brief Index used by aa_hd / aa_2d when it covers the queried dataset (nullptr = none).
+ *        Set by callers that run many queries on one dataset (main, reverse query); the
+ *        dataset must not change while it is set.
+ */
+extern const DominanceIndex* activeDominanceIndex;
+
+/**
+ * \brief partition of \p p through activeDominanceIndex if it covers \p data, getpartition otherwise.
+ */
+DominancePartition partitionRecords(const std::vector<Point>& data, const Point& p);
+
+#endif // DOMINANCEINDEX_H
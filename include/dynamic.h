@@ -0,0 +1,129 @@
+#ifndef DYNAMIC_H
+#define DYNAMIC_H
+
+#include <unordered_map>
+#include <vector>
+#include "geom.h"
+#include "resultcache.h"
+
+/**
+ * \struct TrackedQuery
+ * \brief Result of a tracked query record, kept valid across dataset updates.
+ */
+struct TrackedQuery {
+    CachedResult result;                          ///< maxrank and cells-file witness
+    int dominators = 0;                           ///< Records dominating the query record
+    std::vector<std::vector<double>> witnesses;   ///< Weight vectors (sum 1) at which the maxrank is reached (d > 2 only)
+    bool stale = false;                           ///< An update may have changed the result
+    bool budgetHit = false;                       ///< aa_hd degraded under memoryBudget: the maxrank may be an
+                                                  ///< upper bound, so the query is kept stale (not maintained)
+};
+
+/**
+ * \struct UpdateStats
+ * \brief How dataset updates affected the tracked queries (cumulative).
+ */
+struct UpdateStats {
+    long inserts = 0;        ///< Records inserted
+    long deletes = 0;        ///< Records deleted
+    long shifted = 0;        ///< Query results moved by one (dominator inserted / deleted)
+    long unaffected = 0;     ///< Query results proven unchanged by an incomparable record
+    long invalidated = 0;    ///< Query results marked stale
+    long recomputed = 0;     ///< Stale results recomputed
+    long dropped = 0;        ///< Tracked queries whose record was deleted
+};
+
+/**
+ * \class DynamicDataset
+ * \brief A dataset that accepts insertions and deletions and keeps the MaxRank of its
+ *        tracked query records up to date, recomputing only the ones an update may affect.
+ *
+ * For a tracked record p with maxrank R:
+ *  - a record that dominates p adds (removes) 1 to the rank under every weighting, so R
+ *    shifts by one and the minimal cells stay the same;
+ *  - a record dominated by p (or equal to it) never ranks above p;
+ *  - an inserted incomparable record r leaves R unchanged if some witness weighting still
+ *    scores p strictly better than r (the witnesses beaten by r are dropped); otherwise
+ *    the result may be R or R + 1 and the query is marked stale;
+ *  - a deleted incomparable record can only lower R below what the other records allow
+ *    when R > dominators + 1, in which case the query is marked stale.
+ * Stale queries are recomputed lazily (query()) or all at once (refresh()). A result
+ * degraded by memoryBudget may be an upper bound, so it is returned but kept stale.
+ *
+ * Queries are addressed by record id. Witnesses are the minimal-cell weights for d > 2.
+ * 2D results keep their ranges (in result.witness) but never fill witnesses, so in 2D every
+ * incomparable insert marks the query stale and it is always recomputed; dominator updates
+ * and the dominators + 1 rule of deletes still apply.
+ */
+class DynamicDataset {
+public:
+    explicit DynamicDataset(std::vector<Point> data);
+
+    /**
+     * \brief The current records.
+     */
+    [[nodiscard]] const std::vector<Point>& records() const { return data; }
+
+    /**
+     * \brief Record with the given id, or nullptr.
+     */
+    [[nodiscard]] const Point* record(int id) const;
+
+    /**
+     * \brief Result of record \p id, computed (and tracked from now on) if it is not
+     *        tracked yet or stale.
+     * \throws std::invalid_argument if there is no such record.
+     */
+    const TrackedQuery& query(int id);
+
+    /**
+     * \brief Up-to-date result of record \p id, or nullptr if untracked or stale.
+     */
+    [[nodiscard]] const TrackedQuery* cached(int id) const;
+
+    /**
+     * \brief Tracks record \p id with a result computed elsewhere (e.g. the result cache).
+     */
+    void adopt(int id, const CachedResult& result);
+
+    /**
+     * \brief Inserts a record; its id must not be in use (a negative id takes the next free one).
+     * \return The id of the inserted record.
+     */
+    int insert(const std::vector<double>& coord, int id = -1);
+
+    /**
+     * \brief Deletes a record (and stops tracking it).
+     * \throws std::invalid_argument if there is no such record.
+     */
+    void remove(int id);
+
+    /**
+     * \brief Recomputes every stale tracked query.
+     * \return Number of queries recomputed.
+     */
+    size_t refresh();
+
+    /**
+     * \brief Tracked queries (fresh and stale) by record id.
+     */
+    [[nodiscard]] const std::unordered_map<int, TrackedQuery>& tracked() const { return queries; }
+
+    [[nodiscard]] const UpdateStats& stats() const { return updates; }
+
+    /**
+     * \brief Runs the engine for a record (aa_hd for d > 2, aa_2d otherwise) against \p data.
+     */
+    static TrackedQuery compute(const std::vector<Point>& data, const Point& p);
+
+private:
+    std::vector<Point> data;
+    std::unordered_map<int, size_t> index;       ///< Record id -> position in data
+    std::unordered_map<int, TrackedQuery> queries;
+    int nextId = 1;
+    UpdateStats updates;
+
+    void reindex();
+};
+
+#endif // DYNAMIC_H
@@ -0,0 +1,52 @@
+#ifndef EXPLAIN_H
+#define EXPLAIN_H
+
+#include <cstddef>
+#include <map>
+#include <ostream>
+#include <vector>
+
+class QTree;
+
+/**
+ * \struct ExplainCycle
+ * \brief Shape of the QTree and outcome of the leaf search in one expansion cycle
+ *        (collected only when explainMode is set).
+ */
+struct ExplainCycle {
+    int cycle = 0;                              ///< Expansion cycle (0 = first search)
+    int macroRootsPopulated = 0;                ///< Macro-roots that have a subtree
+    int macroRootsTotal = 0;                    ///< Macro-roots available (2^dims)
+    std::vector<size_t> nodesPerLevel;          ///< QNodes per level (index = QNode::level)
+    std::vector<size_t> leavesPerLevel;         ///< Leaves per level
+    std::map<size_t, size_t> leafHalfspaces;    ///< halfspaces.size() of a leaf -> number of leaves
+    size_t leaves = 0;                          ///< Leaves sorted for the search
+    size_t leavesSearched = 0;                  ///< Leaves searched
+    size_t leavesPruned = 0;                    ///< Children and macro sub-MBRs outside the simplex not created by the insertion before the search
+    size_t leavesCutOff = 0;                    ///< Leaves never visited because of the minorder break
+    std::map<int, size_t> hamweightReached;     ///< Last Hamming weight tried in a leaf -> number of leaves
+    size_t mincells = 0;                        ///< Minimal cells found in the cycle
+    size_t halfspacesToExpand = 0;              ///< AUGMENTED halfspaces expanded after the cycle
+};
+
+/**
+ * \brief Cycles of the query currently (or last) processed by aa_hd; cleared at every query.
+ */
+extern std::vector<ExplainCycle> queryExplain;
+
+/**
+ * \brief Fills the tree-shape fields (macro-roots, nodes, leaves, leaf halfspace histogram).
+ * \param qt  The QTree after the insertions of the cycle.
+ * \param out Receives the shape statistics.
+ */
+void explainQTree(const QTree& qt, ExplainCycle& out);
+
+/**
+ * \brief Writes the cycles of a query as JSON lines (one JSON object per cycle).
+ * \param out     Destination stream.
+ * \param queryId Query record id, repeated in every line.
+ * \param cycles  Cycles to write.
+ */
+void writeExplainJSON(std::ostream& out, int queryId, const std::vector<ExplainCycle>& cycles);
+
+#endif // EXPLAIN_H
@@ -91,6 +91,13 @@ public:
  */
 Point find_halflines_intersection(const HalfLine& r, const HalfLine& s);
 
+/**
+ * \brief Width below which a range of x between two intersections with p's halfline is
+ *        empty: lines meeting p's line in one point (tied records) give intersections that
+ *        differ by rounding only, and p's rank on the gap between them is not reachable.
+ */
+constexpr double halflineTieEps = 1e-12;
+
 /**
  * \brief Checks the position of a Point relative to a HalfSpace.
  * \param point The point to test.
@@ -153,6 +160,27 @@ public:
         return (cache.find(id) != cache.end());
     }
 
+    /**
+     * \brief Number of halfspaces in the cache.
+     */
+    size_t size() const {
+        return cache.size();
+    }
+
+    /**
+     * \brief Approximate bytes held by the cache: hash table, entries and halfspaces
+     *        (allocator overhead excluded).
+     */
+    size_t memoryBytes() const {
+        size_t bytes = cache.bucket_count() * sizeof(void*);
+        for (const auto& [id, hs] : cache) {
+            // map node (next pointer + entry), shared control block + HalfSpace, coefficients
+            bytes += sizeof(void*) + sizeof(std::pair<const long, std::shared_ptr<HalfSpace>>);
+            if (hs) bytes += 2 * sizeof(long) + sizeof(HalfSpace) + hs->coeff.capacity() * sizeof(double);
+        }
+        return bytes;
+    }
+
 private:
     /**
      * \brief Internal storage of <halfspaceID, pointer> pairs.
@@ -184,7 +212,7 @@ extern HalfSpaceCache* halfspaceCache;
  * \brief Initializes halfspaceCache with a fixed size.
  * \param cacheSize The maximum number of halfspaces to store.
  */
-static void initializeCache(const size_t cacheSize) {
+inline void initializeCache(const size_t cacheSize) {
     if (!halfspaceCache) {
         halfspaceCache = new HalfSpaceCache(cacheSize);
     }
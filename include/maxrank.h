@@ -12,6 +12,7 @@
 #include <cmath>
 #include <iostream>
 #include <limits>
+#include <stdexcept>
 
 /**
  * \brief Global configurable parameters for the MaxRank approach.
@@ -21,6 +22,27 @@ extern int maxLevelQTree;          ///< Maximum allowed QTree depth
 extern int maxCapacityQNode;       ///< Maximum capacity of halfspaces in a QNode
 extern int maxNoBinStringToCheck;  ///< Maximum number of binary strings to check
 
+/**
+ * \brief Seconds after which aa_hd gives up on a query by throwing QueryTimeout (0 = no limit).
+ *        Not a user parameter: set by callers that compare configurations (autotune).
+ */
+extern double queryTimeLimit;
+
+/**
+ * \class QueryTimeout
+ * \brief Thrown by aa_hd when a query runs longer than queryTimeLimit.
+ */
+class QueryTimeout : public std::runtime_error {
+public:
+    using std::runtime_error::runtime_error;
+};
+
+/**
+ * \brief Throws QueryTimeout if the query in progress has exceeded queryTimeLimit.
+ *        Called between leaves and between LPs; does nothing when no limit is set.
+ */
+void checkQueryDeadline();
+
 /**
  * \brief Main function for multi-dimensional MaxRank (d > 2).
  * \param data A set of points in the dataset.
@@ -29,9 +51,21 @@ extern int maxNoBinStringToCheck;  ///< Maximum number of binary strings to chec
  *
  * \note This algorithm expands halfspaces around \p p, subdividing the space
  *       to find minimal cells that satisfy the ordering constraints.
+ *       With boundSamples > 0, p's best rank over sampled weight vectors caps the search
+ *       from the first cycle; it is returned, with a cell at the sampled weights, when
+ *       no better cell is found within it.
+ *
+ * \param rankThreshold If positive, only decides whether \p p can reach rank <= rankThreshold:
+ *        the search is limited to cells of order <= rankThreshold - dominators - 1 and stops at
+ *        the first exact one. The returned rank is then <= rankThreshold (an upper bound of the
+ *        MaxRank, with its cell) if reachable, and > rankThreshold (a lower bound, no cell) if not.
+ *        When the limits cut that search short (limits_hit > 0) and it finds no cell, the full
+ *        search runs instead and its result is returned, with the same guarantees as without
+ *        rankThreshold.
  */
 std::pair<int, std::vector<Cell>> aa_hd(const std::vector<Point>& data,
-                                        const Point& p);
+                                        const Point& p,
+                                        int rankThreshold = 0);
 
 /**
  * \brief Special case for 2D MaxRank approach.
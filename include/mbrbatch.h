@@ -0,0 +1,115 @@
+#ifndef MBRBATCH_H
+#define MBRBATCH_H
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+/**
+ * \enum PositionHS
+ * \brief Relative position of a node's MBR with respect to a halfspace.
+ */
+enum class PositionHS { BELOW, ABOVE, OVERLAPPED };
+
+/**
+ * \brief Exact position of a box with respect to the halfspace coeff . x <= known:
+ *        BELOW if the whole box satisfies it strictly, ABOVE if no point of the box
+ *        satisfies it, OVERLAPPED otherwise. Sums are taken in double over the float
+ *        box bounds, in dimension order; every classification of the QTree goes
+ *        through this arithmetic (or agrees with it).
+ * \param lowAt  lowAt(d): lower bound of the box in dimension d.
+ * \param highAt highAt(d): upper bound of the box in dimension d.
+ */
+template <typename LowAt, typename HighAt>
+PositionHS exactMbrPosition(const std::vector<double>& coeff, const double known, LowAt lowAt, HighAt highAt) {
+    double minVal = 0.0, maxVal = 0.0;
+    for (size_t d = 0; d < coeff.size(); ++d) {
+        const double c = coeff[d];
+        const float low = lowAt(d);
+        const float high = highAt(d);
+        if (c >= 0) {
+            minVal += c * low;
+            maxVal += c * high;
+        } else {
+            minVal += c * high;
+            maxVal += c * low;
+        }
+    }
+    if (maxVal < known) return PositionHS::BELOW;
+    if (minVal > known) return PositionHS::ABOVE;
+    return PositionHS::OVERLAPPED;
+}
+
+/**
+ * \brief Exact position, with respect to the halfspace coeff . x <= known, of the part of a
+ *        box that lies in the simplex sum(x) <= 1, for a box that exactMbrPosition() finds
+ *        OVERLAPPED. A box across sum(x) = 1 may be overlapped only outside the simplex:
+ *        the part inside can still be covered by the halfspace or out of it entirely.
+ *        The extremes of coeff . x over that part are reached from the lowest corner by
+ *        spending the budget 1 - sum(low) on the largest (smallest) coefficients first.
+ * \return BELOW, ABOVE or OVERLAPPED as exactMbrPosition() would give for that part;
+ *         OVERLAPPED if the box lies in the simplex.
+ */
+PositionHS simplexPartPosition(const std::vector<double>& coeff, double known,
+                               const std::vector<std::array<float, 2>>& mbr);
+
+/**
+ * \class MbrBatch
+ * \brief A fixed set of boxes classified together against one halfspace at a time
+ *        (the sub-MBRs of the macro-split, the children of a QNode).
+ *
+ * classify() evaluates the box bounds of 16 boxes at once in float: in one AVX-512 register
+ * when the CPU has it (checked at run time, x86-64 GCC / Clang builds), otherwise in a plain
+ * loop the compiler maps to two AVX2 (four SSE) registers. A box is settled only when the
+ * float result is farther from the hyperplane than a bound on its rounding error, taken once
+ * per halfspace over the whole batch.
+ * The few boxes within that margin, and halfspaces whose coefficients do not fit a
+ * normal float, are recomputed with exactMbrPosition(), so the result is always the
+ * one of the double computation.
+ */
+class MbrBatch {
+public:
+    static constexpr size_t lanes = 16;
+
+    MbrBatch() = default;
+
+    /**
+     * \param boxes Boxes of equal dimensionality, [min,max] per dimension.
+     */
+    explicit MbrBatch(const std::vector<std::vector<std::array<float, 2>>>& boxes);
+
+    [[nodiscard]] size_t size() const { return count; }
+
+    /**
+     * \brief Position of every box with respect to coeff . x <= known.
+     * \param out Receives size() positions, in box order.
+     * \return Number of boxes that needed the exact double computation.
+     */
+    size_t classify(const std::vector<double>& coeff, double known, PositionHS* out) const;
+
+    /**
+     * \brief Bytes held by the float bounds.
+     */
+    [[nodiscard]] size_t bytes() const;
+
+    /**
+     * \brief True if classify() runs the AVX-512 path.
+     */
+    [[nodiscard]] static bool avx512();
+
+    /**
+     * \brief Turns the AVX-512 path off (or back on where the CPU has it), for the harness
+     *        and the benchmarks to check and time both paths.
+     */
+    static void setAvx512(bool enabled);
+
+private:
+    size_t count = 0;
+    size_t padded = 0;          ///< count rounded up to a multiple of lanes
+    size_t dims = 0;
+    std::vector<float> low;     ///< low[d * padded + b]
+    std::vector<float> high;    ///< high[d * padded + b]
+    std::vector<float> reach;   ///< reach[d] = max over the boxes of max(|low|, |high|), scales the error bound
+};
+
+#endif // MBRBATCH_H
@@ -0,0 +1,53 @@
+#ifndef MEMBUDGET_H
+#define MEMBUDGET_H
+
+#include <cstddef>
+
+/**
+ * \class MemoryBudget
+ * \brief Memory governor of the query in progress (config memoryBudget).
+ *
+ * aa_hd starts it at the beginning of every query and asks near() at the end of the
+ * insertions and of every expansion cycle; the QTree asks it every budgetCheckSplits
+ * node splits. Once near() holds, the query degrades instead of growing further
+ * (see aa_hd): the QTree stops splitting, the leaves that will not be searched again
+ * drop their halfspaces and the leaf search keeps only what it needs.
+ */
+class MemoryBudget {
+public:
+    static constexpr double highWater = 0.9;          ///< Fraction of the limit at which near() holds
+    static constexpr size_t budgetCheckSplits = 1024;  ///< Node splits between two checks of the QTree
+
+    /**
+     * \brief Starts watching a query: the limit is memoryBudget MB, capped by the process
+     *        RSS now plus the memory still available in the system (getAvailableMemory).
+     *        Does nothing if memoryBudget is 0.
+     */
+    void start();
+
+    /**
+     * \brief True if a budget is set for the query in progress.
+     */
+    [[nodiscard]] bool enabled() const { return limit > 0; }
+
+    /**
+     * \brief True if the larger of the process RSS and \p trackedBytes (the structures
+     *        accounted by memstats) is above highWater of the limit.
+     */
+    [[nodiscard]] bool near(size_t trackedBytes = 0) const;
+
+    /**
+     * \brief The limit of the query in progress in bytes (0 if no budget).
+     */
+    [[nodiscard]] size_t limitBytes() const { return limit; }
+
+private:
+    size_t limit = 0;
+};
+
+/**
+ * \brief Memory governor of the query currently processed by aa_hd.
+ */
+extern MemoryBudget queryBudget;
+
+#endif // MEMBUDGET_H
@@ -0,0 +1,62 @@
+#ifndef MEMSTATS_H
+#define MEMSTATS_H
+
+#include <cstddef>
+#include <vector>
+#include "geom.h"
+
+class QTree;
+class Cell;
+
+/**
+ * \struct MemoryStats
+ * \brief Bytes held by the main structures of a query at one point in time.
+ *
+ * Sizes are payload bytes computed from element counts and vector capacities
+ * (allocator overhead excluded), so they can be compared across structures and runs.
+ */
+struct MemoryStats {
+    size_t qtreeNodes = 0;                ///< QNodes in the root and macro-root subtrees
+    std::vector<size_t> nodesPerLevel;    ///< QNodes at each level (index = QNode::level)
+    size_t qtreeBytes = 0;                ///< QNodes with their children / covered / halfspaces / mbr vectors
+    size_t halfspaceBytes = 0;            ///< halfspaceCache and pointToHalfSpaceCache
+    size_t cellBytes = 0;                 ///< Minimal cells found so far
+    size_t skylineBytes = 0;              ///< Skyline and incomparables buffers
+    size_t rssBytes = 0;                  ///< Resident memory of the process (getCurrentMemory)
+
+    /**
+     * \brief Sum of the tracked structures (RSS excluded).
+     */
+    [[nodiscard]] size_t trackedBytes() const {
+        return qtreeBytes + halfspaceBytes + cellBytes + skylineBytes;
+    }
+
+    /**
+     * \brief Raises every field to the maximum of itself and \p other.
+     */
+    void maxWith(const MemoryStats& other);
+};
+
+/**
+ * \brief Counts the nodes (total and per level) and bytes of a QTree.
+ * \param qt  The tree (classical root and macro-roots are both visited).
+ * \param out Receives qtreeNodes, nodesPerLevel and qtreeBytes.
+ */
+void accountQTree(const QTree& qt, MemoryStats& out);
+
+/**
+ * \brief Bytes held by the global halfspace caches.
+ */
+size_t halfspaceStorageBytes();
+
+/**
+ * \brief Bytes held by a vector of points (coordinates included).
+ */
+size_t pointsBytes(const std::vector<Point>& points);
+
+/**
+ * \brief Bytes held by a vector of cells (masks, halfspace lists, MBRs and feasible points included).
+ */
+size_t cellsBytes(const std::vector<Cell>& cells);
+
+#endif // MEMSTATS_H
@@ -0,0 +1,171 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "memstats.h"
+#include "perfcounters.h"
+
+/**
+ * \brief Phases of aa_hd measured by ScopedPhase.
+ */
+enum class Phase {
+    DOMINANCE,      ///< Dominators / incomparables scan
+    SAMPLING,       ///< Sampled upper bound of the rank
+    SKYLINE,        ///< getskyline
+    HALFSPACES,     ///< genhalfspaces (and removal of already inserted ones)
+    INSERT,         ///< Insertion of the new halfspaces in the QTree
+    LEAF_SEARCH,    ///< Leaf scan, Hamming strings and LPs
+    COUNT
+};
+
+constexpr int numPhases = static_cast<int>(Phase::COUNT);
+
+/**
+ * \brief Column prefix of each phase in the metrics file.
+ */
+constexpr std::array<const char*, numPhases> phaseNames = {
+    "dominance", "sampling", "skyline", "halfspaces", "insert", "leafsearch"
+};
+
+/**
+ * \struct PhaseCounters
+ * \brief Wall time and hardware counters accumulated by one phase over a query.
+ */
+struct PhaseCounters {
+    double time = 0.0;          ///< Seconds
+    HwCounterValues hw{};       ///< Counter deltas, indexed by HwCounter (zero if unavailable)
+};
+
+/**
+ * \struct QueryMetrics
+ * \brief Counters and timers collected while answering a single MaxRank query.
+ *
+ * aa_hd resets the global instance at the beginning of every query; the hot paths
+ * (expansion loop, searchmincells_lp) only increment plain fields.
+ */
+struct QueryMetrics {
+    int expansionCycles = 0;        ///< Expansion cycles run (including the first one)
+    long lpsSolved = 0;             ///< LPs passed to HiGHS
+    long lpsFeasible = 0;           ///< LPs with an optimal (feasible) solution
+    long leavesVisited = 0;         ///< Leaves examined by the leaf search
+    long leavesPruned = 0;          ///< QTree children and macro sub-MBRs outside the simplex, never created
+    long hamstringsGenerated = 0;   ///< Hamming strings produced by genhammingstrings
+    long halfspacesInserted = 0;    ///< Halfspaces inserted in the QTree
+    long limitsHit = 0;             ///< Leaf searches cut short by limitHamWeight, halfspacesLengthLimit
+                                    ///< or maxNoBinStringToCheck (result may be approximate)
+    int sampledBound = 0;           ///< Best sampled rank, an upper bound of the MaxRank (0 if not sampled)
+    long skybandPruned = 0;         ///< Incomparables dropped by the k-skyband prefilter
+
+    double skylineTime = 0.0;       ///< Seconds spent in getskyline
+    double insertTime = 0.0;        ///< Seconds spent inserting halfspaces in the QTree
+    double lpTime = 0.0;            ///< Seconds spent in linprog_highs
+    double totalTime = 0.0;         ///< Seconds spent in the whole query
+
+    std::array<PhaseCounters, numPhases> phases{};  ///< Per-phase wall time and hardware counters
+
+    std::vector<MemoryStats> cycleMemory;  ///< Memory at the end of each expansion cycle
+    MemoryStats peakMemory;                ///< Per-structure maximum over the cycles
+    size_t peakTrackedBytes = 0;           ///< Maximum of MemoryStats::trackedBytes() over the cycles
+    size_t peakRssBytes = 0;               ///< Process peak RSS during the query (0 if not measured)
+    bool memoryBudgetHit = false;          ///< The query got close to memoryBudget and degraded
+
+    /**
+     * \brief Stores the memory snapshot of an expansion cycle and updates the peaks.
+     */
+    void recordMemory(const MemoryStats& mem) {
+        cycleMemory.push_back(mem);
+        peakMemory.maxWith(mem);
+        peakTrackedBytes = std::max(peakTrackedBytes, mem.trackedBytes());
+    }
+
+    /**
+     * \brief Clears every counter and timer.
+     */
+    void reset() { *this = QueryMetrics(); }
+};
+
+/**
+ * \brief Metrics of the query currently (or last) processed by aa_hd.
+ */
+extern QueryMetrics queryMetrics;
+
+/**
+ * \class ScopedTimer
+ * \brief Adds the time elapsed between construction and destruction to a counter (seconds).
+ */
+class ScopedTimer {
+public:
+    explicit ScopedTimer(double& target)
+        : target(target), start(std::chrono::high_resolution_clock::now()) {}
+
+    ~ScopedTimer() {
+        const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+        target += elapsed.count();
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    double& target;
+    std::chrono::high_resolution_clock::time_point start;
+};
+
+/**
+ * \class ScopedPhase
+ * \brief Adds wall time and hardware counter deltas between construction and stop()
+ *        (or destruction) to the given phase of queryMetrics.
+ *
+ * Counters are read only if perfCounters is enabled and openPerfCounters() succeeded.
+ */
+class ScopedPhase {
+public:
+    explicit ScopedPhase(Phase phase);
+    ~ScopedPhase() { stop(); }
+
+    /**
+     * \brief Ends the measurement early (further calls do nothing).
+     */
+    void stop();
+
+    ScopedPhase(const ScopedPhase&) = delete;
+    ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+private:
+    PhaseCounters& target;
+    bool running;
+    HwCounterValues startHw;
+    std::chrono::high_resolution_clock::time_point start;
+};
+
+/**
+ * \struct MetricsRecord
+ * \brief Metrics of one processed query, as written to the metrics file.
+ */
+struct MetricsRecord {
+    int id;                 ///< Query record id
+    int maxrank;            ///< Result of the query
+    QueryMetrics metrics;   ///< Counters and timers of the query
+};
+
+/**
+ * \brief Writes per-query metrics as CSV (one row per query).
+ * \param filename Path to the output file.
+ * \param records  Metrics of each processed query.
+ * \param append   Appends to an existing file (without repeating the header), e.g. on resume.
+ */
+void writeMetricsCSV(const std::string& filename, const std::vector<MetricsRecord>& records, bool append = false);
+
+/**
+ * \brief Writes the memory snapshot of every expansion cycle as CSV (one row per query and cycle).
+ * \param filename Path to the output file.
+ * \param records  Metrics of each processed query.
+ * \param append   Appends to an existing file (without repeating the header), e.g. on resume.
+ */
+void writeMemoryCSV(const std::string& filename, const std::vector<MetricsRecord>& records, bool append = false);
+
+#endif // METRICS_H
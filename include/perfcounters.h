@@ -0,0 +1,54 @@
+#ifndef PERFCOUNTERS_H
+#define PERFCOUNTERS_H
+
+#include <array>
+#include <cstdint>
+
+/**
+ * \brief Hardware events sampled around the phases of a query.
+ */
+enum class HwCounter {
+    CYCLES,
+    INSTRUCTIONS,
+    LLC_MISSES,
+    BRANCH_MISSES,
+    COUNT
+};
+
+constexpr int numHwCounters = static_cast<int>(HwCounter::COUNT);
+
+/**
+ * \brief Snapshot of the hardware counters (cumulative since they were opened).
+ */
+using HwCounterValues = std::array<uint64_t, numHwCounters>;
+
+/**
+ * \brief Value readPerfCounters() stores for a counter whose read failed.
+ */
+constexpr uint64_t hwCounterUnread = UINT64_MAX;
+
+/**
+ * \brief Opens the hardware counters (Linux perf_event_open) for the calling thread and every
+ *        thread it creates afterwards. Call it from the main thread before any query.
+ *
+ * Safe to call more than once. If the platform, the kernel (perf_event_paranoid) or the
+ * machine (e.g. a VM without a virtual PMU) does not provide the events, nothing is opened
+ * and perfCountersAvailable() stays false: callers then report wall time only.
+ *
+ * \return True if the counters are available.
+ */
+bool openPerfCounters();
+
+/**
+ * \brief Whether openPerfCounters() succeeded.
+ */
+bool perfCountersAvailable();
+
+/**
+ * \brief Reads the current value of every counter (scaled if the kernel multiplexed them).
+ * \return The counter values, all zero if the counters are not available; a counter whose
+ *         read failed is hwCounterUnread.
+ */
+HwCounterValues readPerfCounters();
+
+#endif // PERFCOUNTERS_H
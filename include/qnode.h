@@ -4,15 +4,10 @@
 #include <vector>
 #include <array>
 #include "halfspace.h"
+#include "mbrbatch.h"
 
 extern int numOfSubdivisions;    ///< Global number of partitions used in node splitting (2^dims)
 
-/**
- * \enum PositionHS
- * \brief Relative position of a node's MBR with respect to a halfspace.
- */
-enum class PositionHS { BELOW, ABOVE, OVERLAPPED };
-
 class QTree;
 
 /**
@@ -31,8 +26,10 @@ public:
 
     int leafIndex;                          ///< Index used if needed
     std::vector<std::array<float,2>> mbr;   ///< [min,max] bounding region for each dimension in float
+    MbrBatch childBoxes;                    ///< MBRs of the non-null children, in order, set by splitNode
 
     bool norm;     ///< True if this node is valid
+    bool inside;   ///< True if the MBR lies strictly below sum(w) = 1 (MbrIsValid), set at construction
     bool leaf;     ///< True if this node is a leaf (no children)
     size_t order;  ///< Accumulated order (sum of covered halfspaces up the chain)
     int level;     ///< Depth level in the tree (0 = root)
@@ -71,26 +68,52 @@ public:
     void insertHalfspace(long hsID);
 
     /**
-     * \brief Splits this node into children if capacity is exceeded.
+     * \brief Inserts a halfspace whose position with respect to this node's MBR is known.
+     * \param hsID Identifier of the halfspace.
+     * \param hs   The halfspace itself.
+     * \param pos  Position of the MBR with respect to \p hs.
+     */
+    void insertClassified(long hsID, const HalfSpace& hs, PositionHS pos);
+
+    /**
+     * \brief Classifies a halfspace against all children at once (childBoxes) and inserts it
+     *        into each of them.
+     */
+    void insertIntoChildren(long hsID, const HalfSpace& hs);
+
+    /**
+     * \brief Splits this node into children if capacity is exceeded: 2^dims children, or
+     *        2 with a binary split policy of the owner (see QTreeSplit). Sides are cut where
+     *        the owner's SplitPosition puts them (QTree::splitPositions()).
      */
     void splitNode();
 
     /**
-     * \brief Checks if the node is valid in [0,1]^dims (sum of corners <= 1).
-     * \return True if valid, false otherwise.
+     * \brief Dimension cut by a binary split: the widest side (QTreeSplit::WIDEST), or
+     *        the side whose cut leaves the fewest of this node's halfspaces overlapping the
+     *        two children (QTreeSplit::HALFSPACES, widest first on ties).
+     * \param cuts Cut position of every side (QTree::splitPositions()).
+     * \return The dimension, or -1 if no side can be cut any more in float.
      */
-    [[nodiscard]] bool checkNodeValidity() const;
+    [[nodiscard]] int binarySplitDimension(const std::vector<float>& cuts) const;
 
     /**
      * \brief Clears the halfspaces vector in this node.
      */
     void clearHalfspaces();
 
+    /**
+     * \brief True if this leaf still stores a new overlapping halfspace once the owner's
+     *        splits are frozen (memory budget): false if the leaf search would never read it.
+     */
+    [[nodiscard]] bool keepsHalfspacesFrozen() const;
+
     /**
      * \brief Determines how the node's MBR relates to the specified halfspace.
      * \param coeff Coefficients of the halfspace (double).
      * \param known Right-hand side (RHS) of the halfspace (double).
-     * \return PositionHS::BELOW, ABOVE, or OVERLAPPED.
+     * \return PositionHS::BELOW, ABOVE, or OVERLAPPED. A node across sum(w) = 1 is classified
+     *         by its part inside the simplex (simplexPartPosition()).
      */
     [[nodiscard]] PositionHS MbrVersusHalfSpace(const std::vector<double>& coeff, double known) const;
 
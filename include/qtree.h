@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <array>
+#include <atomic>
 #include "qnode.h"
 #include <algorithm>
 #include <future>
@@ -10,6 +11,25 @@
 #include <queue>
 #include <thread>
 
+/**
+ * \enum QTreeSplit
+ * \brief How a QNode splits when it exceeds its capacity (config qtreeSplit).
+ */
+enum class QTreeSplit {
+    QUAD = 0,        ///< Halve every dimension at once: 2^dims children
+    WIDEST = 1,      ///< Halve the widest dimension only: 2 children (k-d style)
+    HALFSPACES = 2   ///< Halve the dimension whose cut leaves the fewest halfspaces overlapping the children
+};
+
+/**
+ * \enum SplitPosition
+ * \brief Where a split cuts each halved side of a node (config splitPosition).
+ */
+enum class SplitPosition {
+    MIDPOINT = 0,  ///< Halfway along the side
+    BALANCED = 1   ///< The candidate cut that best balances the node's halfspaces between the two parts
+};
+
 /**
  * \class QTree
  * \brief Manages an N-dimensional tree structure (like a quadtree or octree)
@@ -20,24 +40,45 @@ public:
 
     int dims;       ///< Number of dimensions in the reduced query space
     int maxhsnode;  ///< Max halfspaces per node before triggering a split
-    int maxLevel;   ///< Maximum depth allowed in this tree
+    int maxLevel;   ///< Maximum depth allowed in this tree (binary splits: maxLevel * dims, same finest cells)
+    QTreeSplit split;  ///< How nodes split
+    SplitPosition position;  ///< Where nodes (and the macro split) cut their sides
+    int macroLevel;    ///< Level of the macro-roots (splits already applied by the macro split)
 
     QNode* root;                     ///< Root node
 
-    std::vector<QNode*> macroRoots;  ///< Collection of macro-root nodes (one per sub-MBR)
+    std::vector<QNode*> macroRoots;  ///< Collection of macro-root nodes (one per sub-MBR reaching the simplex)
     /**
      * \brief Precomputed subdivisions of the unit hypercube:
      *        each sub-MBR is a vector of [min,max] pairs in float.
      */
     std::vector< std::vector<std::array<float,2>> > precomputedSubMBRs;
+    std::vector<int> simplexSubMBRs;  ///< Indices of the sub-MBRs reaching sum(w) <= 1 (the others are skipped)
+    MbrBatch subMBRBoxes;             ///< Those sub-MBRs, laid out for batched classification
+    bool macroCutsFixed;              ///< False until the macro split has its final cuts (see SplitPosition::BALANCED)
+    std::atomic<bool> splitsFrozen{false};      ///< Set when the query gets close to memoryBudget: nodes stop splitting
+    std::atomic<size_t> splitsSinceCheck{0};    ///< Node splits since the last check of the memory budget
+    std::atomic<size_t> nodesPruned{0};         ///< Children and macro sub-MBRs outside the simplex, not created (aa_hd collects and resets it)
+    size_t maxSearchedOrder;                    ///< Leaves of a higher order are never searched (set by aa_hd)
 
     /**
      * \brief Constructor
      * \param dims       Number of dimensions.
      * \param maxhsnode  Max halfspaces per node (splitting threshold).
-     * \param maxLevel   Maximum allowed tree depth.
+     * \param maxLevel   Maximum allowed tree depth, in halvings of every dimension.
+     * \param split      Node split policy. With a binary split each level halves one
+     *                   dimension, the macro split only halves the first macroBinaryDims
+     *                   dimensions, and the depth limit becomes maxLevel * dims.
+     * \param position   Cut position policy. With SplitPosition::BALANCED the macro split
+     *                   takes its cuts from the first batch of halfspaces inserted.
      */
-    QTree(int dims, int maxhsnode, int maxLevel);
+    QTree(int dims, int maxhsnode, int maxLevel, QTreeSplit split = QTreeSplit::QUAD,
+          SplitPosition position = SplitPosition::MIDPOINT);
+
+    static constexpr int macroBinaryDims = 3;  ///< Dimensions halved by the macro split of a binary tree
+
+    /// Candidate cuts of SplitPosition::BALANCED, as fractions of the side (midpoint first: it wins ties)
+    static constexpr float balancedCutFractions[] = {0.5f, 0.375f, 0.625f, 0.25f, 0.75f};
 
     /**
      * \brief Destructor. Destroys the root and all macro-roots.
@@ -50,6 +91,11 @@ public:
      */
     QNode* createroot();
 
+    /**
+     * \brief Creates the macro-roots still missing, one per sub-MBR reaching the simplex.
+     */
+    void createMacroRoots();
+
     /**
      * \brief Destroys both the classical root and all macro-root subtrees.
      */
@@ -57,7 +103,7 @@ public:
 
     /**
      * \brief Inserts halfspaces in parallel, splitting them among the precomputed sub-MBRs.
-     *        If a sub-MBR is fully covered (no partial overlap), no macro-root is created.
+     *        The first batch, even an empty one, fixes the macro split and creates its macro-roots.
      * \param halfspaces Vector of halfspace IDs to distribute and insert.
      */
     void inserthalfspacesMacroSplit(const std::vector<long int>& halfspaces);
@@ -74,21 +120,40 @@ public:
     void updateAllOrders();
 
     /**
-     * \brief Builds a new subtree for the given sub-MBR and halfspace set.
-     * \param subMBR  The bounding region for this subtree (float).
-     * \param subHS   Vector of halfspace IDs to insert incrementally.
-     * \return The newly created QNode pointer as a subtree root.
+     * \brief Counts a node split; every MemoryBudget::budgetCheckSplits splits checks the
+     *        memory budget of the query and freezes the splits if it is close.
      */
-    [[nodiscard]] QNode* buildSubtree(const std::vector<std::array<float,2>>& subMBR,
-                                      const std::vector<long>& subHS) const;
+    void noteSplit();
 
     /**
-     * \brief Precomputes 2^dims sub-MBRs covering [0,1]^dims, stored as float.
+     * \brief Cut position of every side of an MBR. MIDPOINT halves the side. BALANCED tries
+     *        the balancedCutFractions of the side and keeps the cut whose fuller part (the one
+     *        overlapping more of \p halfspaces, parts outside the simplex counting none)
+     *        overlaps the fewest; every cut stays within the middle half of the side, so a
+     *        split still shrinks it by at least a quarter.
+     * \param mbr        The bounding region (float).
+     * \param halfspaces Halfspace IDs overlapping the region.
+     * \return One cut per dimension.
+     */
+    [[nodiscard]] std::vector<float> splitPositions(const std::vector<std::array<float,2>>& mbr,
+                                                    const std::vector<long>& halfspaces) const;
+
+    /**
+     * \brief Precomputes 2^dims sub-MBRs covering [0,1]^dims, stored as float
+     *        (2^min(dims, macroBinaryDims) with a binary split).
      * \param globalMBR The bounding region, typically the entire unit hypercube (float).
+     * \param cuts      Cut of each side of \p globalMBR (see splitPositions()).
      * \return A list of subdivided MBRs in float.
      */
     [[nodiscard]] std::vector< std::vector<std::array<float,2>> >
-    macroSplitMBR(const std::vector<std::array<float,2>>& globalMBR) const;
+    macroSplitMBR(const std::vector<std::array<float,2>>& globalMBR, const std::vector<float>& cuts) const;
+
+private:
+    /**
+     * \brief Sets the sub-MBRs of the macro split (precomputedSubMBRs, simplexSubMBRs,
+     *        subMBRBoxes) from the cuts of [0,1]^dims. Only valid while no macro-root exists.
+     */
+    void setMacroSplit(const std::vector<float>& cuts);
 };
 
 #endif // QTREE_H
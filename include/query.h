@@ -4,6 +4,27 @@
 #include <vector>
 #include "geom.h"
 
+/**
+ * \struct DominancePartition
+ * \brief Position of every record of a dataset with respect to a query point p.
+ */
+struct DominancePartition {
+    size_t dominators = 0;              ///< Records dominating p
+    size_t dominees = 0;                ///< Records dominated by p
+    std::vector<size_t> incomparables;  ///< Positions in the dataset of the records incomparable with p
+};
+
+/**
+ * \brief Classifies every record against p in a single branch-free pass.
+ *
+ * Records are compared in tiles of 8, one dimension at a time, so that the comparisons
+ * vectorize across records; the same kernel backs every dominance test of query.cpp.
+ * \param data A list of points.
+ * \param p    The reference point.
+ * \return Dominator / dominee counts and the positions of the incomparable records.
+ */
+DominancePartition getpartition(const std::vector<Point>& data, const Point& p);
+
 /**
  * \brief Finds all points that strictly dominate point p in each dimension.
  * \param data A list of points.
@@ -38,4 +59,14 @@ std::vector<Point> getincomparables(const std::vector<Point>& data,
  */
 std::vector<Point> getskyline(const std::vector<Point>& data);
 
+/**
+ * \brief Returns the k-skyband: the points dominated by fewer than k other points.
+ *        Dominance counts stop at k, so each point is compared with at most the
+ *        band found so far until k dominators are seen.
+ * \param data The input set of points.
+ * \param k    Dominance count at which a point is discarded (k = 1 gives the skyline).
+ * \return The points of the band, in their order in \p data.
+ */
+std::vector<Point> getkskyband(const std::vector<Point>& data, int k);
+
 #endif // QUERY_H
@@ -0,0 +1,89 @@
+#ifndef RESULTCACHE_H
+#define RESULTCACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "geom.h"
+
+/**
+ * \struct CachedResult
+ * \brief A query result as stored in the result cache.
+ */
+struct CachedResult {
+    int maxrank;                    ///< Best rank of the query record
+    std::vector<double> witness;    ///< Row of the cells file without the id (weights or w1 ranges)
+};
+
+/**
+ * \brief Content hash (FNV-1a, 64 bit) of a dataset: ids and exact coordinate bits of every record.
+ */
+uint64_t hashDataset(const std::vector<Point>& data);
+
+/**
+ * \brief Version of the results of the engines, part of resultCacheParams(). Bumped by every
+ *        fix that changes results, so that caches written before it are no longer used.
+ */
+constexpr int resultEngineVersion = 3;
+
+/**
+ * \brief The parameters that can change a result, as a canonical "key=value;..." string.
+ * \param engine        Engine answering the queries ("hd", "2d" or "2d-sweep").
+ * \param rankThreshold Decision threshold the results were computed with, 0 for exact MaxRanks.
+ */
+std::string resultCacheParams(const std::string& engine, int rankThreshold);
+
+/**
+ * \class ResultCache
+ * \brief On-disk cache of query results, shared by concurrent runs.
+ *
+ * Results of one (dataset, parameters) pair live in a single append-only file
+ * "<dir>/<dataset hash>_<parameters hash>.cache": a header line with the full parameter
+ * string, then one line per result. Opening (create or read) and every append hold an
+ * exclusive lock on "<file>.lock" (flock / LockFileEx), so runs on the same dataset can fill
+ * the cache at the same time. Each line carries its length and an end marker, so a line
+ * torn by a crashed writer is skipped on load.
+ */
+class ResultCache {
+public:
+    /**
+     * \brief Opens (creating it if needed) the cache of a dataset and parameter set.
+     * \param dir      Cache directory.
+     * \param dataHash hashDataset() of the loaded dataset.
+     * \param params   resultCacheParams() of the run.
+     */
+    ResultCache(const std::string& dir, uint64_t dataHash, const std::string& params);
+
+    /**
+     * \brief Looks up the result of a query record.
+     * \param id  Query record id (1-based index, as in the query file).
+     * \param out Receives the result on a hit.
+     * \return True on a hit.
+     */
+    bool lookup(int id, CachedResult& out) const;
+
+    /**
+     * \brief Stores a result in memory and appends it to the cache file.
+     */
+    void store(int id, const CachedResult& result);
+
+    /**
+     * \brief Number of results available.
+     */
+    [[nodiscard]] size_t size() const { return entries.size(); }
+
+    /**
+     * \brief Path of the cache file.
+     */
+    [[nodiscard]] const std::string& path() const { return filename; }
+
+private:
+    std::string filename;
+    std::string params;
+    std::unordered_map<int, CachedResult> entries;
+
+    void load();
+};
+
+#endif // RESULTCACHE_H
@@ -0,0 +1,52 @@
+#ifndef REVERSE_H
+#define REVERSE_H
+
+#include <vector>
+#include "geom.h"
+
+/**
+ * \struct ReverseMatch
+ * \brief A record that can reach rank <= k under some weighting.
+ */
+struct ReverseMatch {
+    int id;                        ///< Record id
+    int rank;                      ///< Rank reached at the witness, <= k. For a sampled match it is the best
+                                   ///< sampled rank, an upper bound of the MaxRank (exact when it is 1); a
+                                   ///< decision query returns an upper bound too for d > 2, the MaxRank in 2D
+    std::vector<double> witness;   ///< Weight vector (sum 1) at which the rank is reached
+    bool sampled;                  ///< Found by the shared sampling pass (false: by a decision query)
+};
+
+/**
+ * \struct ReverseStats
+ * \brief How the records of a reverse query were settled.
+ */
+struct ReverseStats {
+    size_t records = 0;      ///< Records in the dataset
+    size_t candidates = 0;   ///< Records with fewer than k dominators (the k-skyband)
+    size_t hull = 0;         ///< Candidates ranked first at a sampled weighting (the lower convex hull, as far as the samples reach)
+    size_t sampled = 0;      ///< Candidates answered by the sampling pass (hull included)
+    size_t searched = 0;     ///< Candidates left to a decision query
+    size_t matches = 0;      ///< Records in the answer set
+};
+
+/**
+ * \brief Reverse MaxRank: every record that can reach rank <= k under some weighting.
+ *
+ * Work is shared between the records instead of running one full query per record:
+ *  - a record with k or more dominators can never make it, so only the k-skyband is kept;
+ *  - one sampling pass scores every record at the simplex vertices, centroid and
+ *    boundSamples random weightings, and ranks all candidates from the sorted scores.
+ *    Candidates ranked first somewhere (the lower convex hull, as far as the samples
+ *    reach) and all others ranked <= k at some sample are answered right away;
+ *  - the remaining candidates get a decision query: aa_hd with rankThreshold = k for
+ *    d > 2, the batch 2D engine otherwise.
+ *
+ * \param data  The dataset.
+ * \param k     Rank to reach (>= 1).
+ * \param stats If not null, receives how the records were settled.
+ * \return The answer set, by increasing record id.
+ */
+std::vector<ReverseMatch> reverseMaxRank(const std::vector<Point>& data, int k, ReverseStats* stats = nullptr);
+
+#endif // REVERSE_H
@@ -0,0 +1,68 @@
+#ifndef SAMPLING_H
+#define SAMPLING_H
+
+#include <vector>
+#include "geom.h"
+
+/**
+ * \brief Weight vectors of the simplex (each sums to 1) used to sample ranks: the
+ *        vertices, the centroid, then \p samples uniform weights, one in three of them
+ *        on a random face. The same seed always gives the same weights.
+ */
+std::vector<std::vector<double>> sampleSimplexWeights(int dims, int samples, unsigned int seed);
+
+/**
+ * \struct SampledRank
+ * \brief Best weight vector found by RankSampler.
+ */
+struct SampledRank {
+    int below = 0;                 ///< Records scoring below the query record at weights
+    std::vector<double> weights;   ///< The weight vector (empty if none was sampled)
+};
+
+/**
+ * \class RankSampler
+ * \brief Counts, for many weight vectors at once, the records that score below a query
+ *        record (lower score = better rank).
+ *
+ * Records are stored by dimension (structure of arrays) and the weights are processed in
+ * blocks: for each block the scores of all records are accumulated dimension by
+ * dimension in contiguous buffers, as in a matrix product, so the inner loops vectorize.
+ */
+class RankSampler {
+public:
+    /**
+     * \param records Records to count (may be empty).
+     * \param dims    Dimensions of the records and of the weight vectors.
+     */
+    RankSampler(const std::vector<Point>& records, int dims);
+
+    /**
+     * \brief Weight vector with the fewest records scoring below \p p.
+     * \param tolerance A record counts if its score is < p's score + tolerance: negative
+     *        values ignore near ties, positive values count them (a conservative count,
+     *        valid in a neighbourhood of the weights).
+     */
+    [[nodiscard]] SampledRank best(const Point& p, const std::vector<std::vector<double>>& weights,
+                                   double tolerance) const;
+
+    /**
+     * \brief best() for several of the sampler's own records in one pass: the scores of
+     *        all records are computed once per weight vector and sorted, and each target's
+     *        count is read from them by binary search. Weight vectors are split over
+     *        workerThreads().
+     * \param targets   Positions of the target records in the sampler's records.
+     * \param tolerance As in best(); a target never counts itself.
+     * \return One SampledRank per target, in the order of \p targets.
+     */
+    [[nodiscard]] std::vector<SampledRank> bestForRecords(const std::vector<size_t>& targets,
+                                                          const std::vector<std::vector<double>>& weights,
+                                                          double tolerance) const;
+
+private:
+    size_t n;
+    int dims;
+    std::vector<std::vector<double>> cols;   ///< cols[d][i] = coordinate d of record i
+};
+
+#endif // SAMPLING_H
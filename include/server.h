@@ -0,0 +1,145 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <iosfwd>
+#include <sstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "dynamic.h"
+#include "geom.h"
+#include "resultcache.h"
+
+/**
+ * \struct ServerStats
+ * \brief Counters of a running server (returned by the "stats" request).
+ */
+struct ServerStats {
+    long requests = 0;          ///< Request lines handled (any kind)
+    long rankQueries = 0;       ///< "rank" requests answered
+    long pointQueries = 0;      ///< "point" requests answered
+    long memoHits = 0;          ///< "rank" requests answered without running the engine
+    long updates = 0;           ///< "insert" / "delete" requests applied
+    long errors = 0;            ///< Requests answered with "err"
+    long connections = 0;       ///< Connections accepted
+    int activeConnections = 0;  ///< Connections being served by a worker
+    int queuedConnections = 0;  ///< Connections waiting for a free worker
+    double totalQuerySeconds = 0.0;  ///< Engine time of the rank / point requests
+    double maxQuerySeconds = 0.0;    ///< Slowest engine call
+};
+
+/**
+ * \class MaxRankServer
+ * \brief Answers MaxRank requests over a line protocol against a dataset loaded once.
+ *
+ * Requests (one per line, one response line each, in order on a connection):
+ *  - "rank <id>"              MaxRank of the record with id <id> (first column of the dataset)
+ *  - "point <c1> ... <cd>"    MaxRank of an ad-hoc record with the given coordinates
+ *  - "insert [id=<id>] <c1> ... <cd>"  Adds a record (next free id if omitted)
+ *  - "delete <id>"            Removes a record
+ *  - "stats"                  Server counters
+ *  - "quit"                   Closes the connection
+ *  - "shutdown"               Stops the server
+ *
+ * Answers are "ok <maxrank> <witness...>" (the row of the cells file without the id: the
+ * weights of a minimal cell for d > 2, the w1 ranges in 2D), "ok <id> key=value ..." for
+ * updates, "stats key=value ..." or "err <message>".
+ *
+ * Connections are served by a fixed pool of \p workers threads; at most \p queueLimit more
+ * wait for a free one. Queries themselves are serialized: the engine keeps the state of the query in
+ * progress in globals (halfspaceCache, queryMetrics) and already runs its parallel phases
+ * on workerThreads(). "rank" results are memoized in memory and, when a cache is given,
+ * in the persistent result cache until the first update. The dataset is a DynamicDataset:
+ * after an update only the memoized results it may affect are recomputed, on their next
+ * request.
+ */
+class MaxRankServer {
+public:
+    /**
+     * \param data       The initial dataset (copied).
+     * \param workers    Threads serving connections.
+     * \param queueLimit Connections allowed to wait when every worker is busy; further ones are refused.
+     * \param cache      Optional persistent result cache (nullptr = memo only).
+     */
+    MaxRankServer(const std::vector<Point>& data, int workers, int queueLimit, ResultCache* cache = nullptr);
+    ~MaxRankServer();
+
+    MaxRankServer(const MaxRankServer&) = delete;
+    MaxRankServer& operator=(const MaxRankServer&) = delete;
+
+    /**
+     * \brief Handles one request line.
+     * \param line Request.
+     * \param quit Set when the connection must be closed after the response ("quit", "shutdown").
+     * \return Response line (without the newline); empty for blank lines.
+     */
+    std::string handle(const std::string& line, bool& quit);
+
+    /**
+     * \brief Serves a single stream (e.g. stdin / stdout) until EOF, "quit" or "shutdown".
+     */
+    void serveStream(std::istream& in, std::ostream& out);
+
+    /**
+     * \brief Listens on a Unix domain socket and serves connections until stop() or a
+     *        "shutdown" request. Removes a stale socket file first and its own on return.
+     */
+    void serveSocket(const std::string& socketPath);
+
+    /**
+     * \brief Asks serveSocket() to return (safe from a signal-driven watcher or a worker).
+     */
+    void stop() { stopping = true; }
+
+    /**
+     * \brief Snapshot of the counters.
+     */
+    [[nodiscard]] ServerStats stats() const;
+
+private:
+    DynamicDataset dataset;              ///< Guarded by engineMutex
+    const size_t dims;
+    const int workers;
+    const int queueLimit;
+    ResultCache* cache;
+    const std::chrono::steady_clock::time_point started;
+    std::atomic<size_t> recordCount;
+
+    std::atomic<bool> stopping{false};
+    std::mutex engineMutex;              ///< Held while the engine runs (global query state)
+    std::mutex memoMutex;                ///< Guards memo, toAdopt and cache
+    std::unordered_map<int, CachedResult> memo;
+    std::vector<std::pair<int, CachedResult>> toAdopt;  ///< Cache hits not yet tracked by dataset
+
+    mutable std::mutex statsMutex;
+    ServerStats counters;
+
+    std::mutex queueMutex;
+    std::condition_variable queueReady;
+    std::deque<int> pending;             ///< Accepted sockets waiting for a worker
+    int admitted = 0;                    ///< Connections queued or being served (guarded by queueMutex)
+    std::vector<std::thread> pool;
+
+    void recordQueryTime(std::chrono::steady_clock::time_point start);
+    std::vector<double> parseCoords(std::istringstream& ss, size_t count) const;
+    std::string update(const std::string& cmd, std::istringstream& ss);  ///< "insert" / "delete"
+    std::string formatStats() const;
+    void serveConnection(int fd);
+    void workerLoop();
+};
+
+/**
+ * \brief Connects to a server socket.
+ * \return The connected socket descriptor.
+ * \throws std::runtime_error on failure (or on platforms without Unix sockets).
+ */
+int connectServer(const std::string& socketPath);
+
+#endif // SERVER_H
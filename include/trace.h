@@ -0,0 +1,67 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <chrono>
+#include <string>
+
+/**
+ * Scoped timeline spans in Chrome trace-event format (loadable in Perfetto or chrome://tracing).
+ *
+ * Spans are only recorded when the library is compiled with MAXRANK_TRACE
+ * (cmake -DMAXRANK_TRACE=ON); otherwise TRACE_SCOPE expands to nothing and costs nothing.
+ * Every thread appends to its own buffer, so recording a span takes no lock. Buffers of
+ * finished worker threads are handed to the next thread that starts, so the timeline keeps
+ * one track per concurrently running worker instead of one per std::async call.
+ */
+
+#ifdef MAXRANK_TRACE
+constexpr bool traceEnabled = true;
+#else
+constexpr bool traceEnabled = false;
+#endif
+
+/**
+ * \class TraceSpan
+ * \brief Records a complete event ("ph":"X") covering its own lifetime on the calling thread.
+ */
+class TraceSpan {
+public:
+    /**
+     * \param name Span name; must be a string literal (only the pointer is stored).
+     * \param arg  Optional integer shown in the span details (e.g. macro-root or cycle index), -1 = none.
+     */
+    explicit TraceSpan(const char* name, long long arg = -1)
+        : name(name), arg(arg), start(std::chrono::steady_clock::now()) {}
+
+    ~TraceSpan();
+
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* name;
+    long long arg;
+    std::chrono::steady_clock::time_point start;
+};
+
+/**
+ * \brief Writes every span recorded so far as a Chrome trace-event JSON file.
+ * \param filename Path to the output file.
+ */
+void writeTrace(const std::string& filename);
+
+/**
+ * \brief Discards every span recorded so far.
+ */
+void clearTrace();
+
+#define TRACE_CONCAT_IMPL(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_IMPL(a, b)
+
+#ifdef MAXRANK_TRACE
+#define TRACE_SCOPE(...) TraceSpan TRACE_CONCAT(traceSpan_, __LINE__)(__VA_ARGS__)
+#else
+#define TRACE_SCOPE(...) ((void)0)
+#endif
+
+#endif // TRACE_H
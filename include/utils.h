@@ -14,30 +14,44 @@
 size_t getAvailableMemory();
 
 /**
- * \brief Reads a file of precomputed binary combinations for a given dimensionality.
- *
- * The file used depends on \p dims (from 2D to 9D).
- * Each line of the file contains a binary string (e.g., "0101") representing a combination.
- *
- * \param dims Integer from 2 to 9, inclusive.
- * \return A vector of binary strings representing combinations.
+ * \brief Retrieves the current resident memory of the current process.
+ * \return Size in bytes, or 0 if it cannot be retrieved.
+ */
+size_t getCurrentMemory();
+
+/**
+ * \brief Retrieves the peak resident memory (high-water mark) of the current process.
+ * \return Size in bytes, or 0 if it cannot be retrieved.
+ */
+size_t getPeakMemory();
+
+/**
+ * \brief Resets the peak resident memory of the current process to its current usage,
+ *        so that getPeakMemory() measures only what happens afterwards.
+ * \return True if the platform supports resetting the high-water mark.
  */
-std::vector<std::string> readCombinations(const int& dims);
+bool resetPeakMemory();
 
 /**
- * \brief Checks if a given MBR (array of [min,max] intervals in each dimension)
- *        is considered "valid" with respect to a user-defined hyperplane.
+ * \brief Checks if a given MBR (array of [min,max] intervals in each dimension) lies
+ *        strictly below the hyperplane w_1 + ... + w_dims = 1 of the reduced weight space.
  *
- * \param mbr        The multi-dimensional bounding region, size = dims.
- * \param Comb       A list of precomputed binary strings used to test MBR vertices.
- * \param dims       The number of dimensions (excluding the last "virtual" coordinate).
- * \param queryPlane An array of floats describing the hyperplane (e.g., q1 + q2 + ... < 1).
+ * Every vertex is below iff the largest vertex sum, the sum of the upper bounds, is:
+ * O(dims) instead of one test per vertex. The sum is taken in float, in dimension order,
+ * as the vertex-by-vertex test did (float addition is monotone, so the results agree).
  *
+ * \param mbr The multi-dimensional bounding region.
  * \return True if all vertices of the MBR lie below the hyperplane, false otherwise.
  */
-bool MbrIsValid(const std::vector<std::array<float, 2>>& mbr,
-                const std::vector<std::string>& Comb,
-                int dims,
-                const float queryPlane[]);
+bool MbrIsValid(const std::vector<std::array<float, 2>>& mbr);
+
+/**
+ * \brief Checks if a given MBR reaches the region w_1 + ... + w_dims <= 1, i.e. if its
+ *        smallest vertex sum (the sum of the lower bounds, taken in double) is <= 1.
+ *
+ * \param mbr The multi-dimensional bounding region.
+ * \return False if the whole MBR lies above the hyperplane.
+ */
+bool MbrIntersectsSimplex(const std::vector<std::array<float, 2>>& mbr);
 
 #endif // UTILS_H
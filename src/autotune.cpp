@@ -0,0 +1,181 @@
+#include "autotune.h"
+#include "config.h"
+#include "maxrank.h"
+#include "metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <limits>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <tuple>
+
+namespace {
+
+void applyConfig(const TuneConfig& c) {
+    maxCapacityQNode = c.maxCapacityQNode;
+    maxLevelQTree = c.maxLevelQTree;
+    limitHamWeight = c.limitHamWeight;
+    halfspacesLengthLimit = c.halfspacesLengthLimit;
+}
+
+} // namespace
+
+std::vector<TuneConfig> autotuneGrid(const int dims) {
+    std::vector<int> levels;
+    if (dims <= 4) levels = {4, 6, 8};
+    else if (dims <= 6) levels = {3, 4, 5};
+    else levels = {2, 3, 4};
+
+    std::vector<TuneConfig> grid;
+    for (const int capacity : {5, 10, 20, 40}) {
+        for (const int level : levels) {
+            for (const int hamWeight : {3, 6, 999}) {
+                for (const int lengthLimit : {16, 21}) {
+                    grid.push_back({capacity, level, hamWeight, lengthLimit});
+                }
+            }
+        }
+    }
+    return grid;
+}
+
+TuneConfig autotune(const std::vector<Point>& data,
+                    const std::vector<int>& queries,
+                    const std::vector<TuneConfig>& grid,
+                    const int sampleSize,
+                    const unsigned int seed,
+                    const double timeFactor,
+                    std::vector<TuneTrial>& trials)
+{
+    if (grid.empty() || queries.empty()) {
+        throw std::invalid_argument("autotune needs at least one candidate and one query");
+    }
+
+    // Nested samples: every rung takes a longer prefix of the same shuffled order
+    std::vector<int> order = queries;
+    std::mt19937 gen(seed);
+    std::shuffle(order.begin(), order.end(), gen);
+
+    // The trials overwrite these globals: they are restored on return, and when a query throws
+    ScopedGlobal<int> keepCapacity(maxCapacityQNode);
+    ScopedGlobal<int> keepLevel(maxLevelQTree);
+    ScopedGlobal<int> keepHamWeight(limitHamWeight);
+    ScopedGlobal<int> keepLengthLimit(halfspacesLengthLimit);
+    ScopedGlobal<double> keepTimeLimit(queryTimeLimit);
+    ScopedGlobal<int> quiet(quietMode, 1);
+
+    // Small leaves and deep trees first (few halfspaces per leaf keep the Hamming enumeration
+    // small), loose limits first: the first exact times of a rung bound the budget of the others
+    std::vector<TuneConfig> candidates = grid;
+    std::stable_sort(candidates.begin(), candidates.end(), [](const TuneConfig& a, const TuneConfig& b) {
+        return std::make_tuple(a.maxCapacityQNode, -a.maxLevelQTree, -a.limitHamWeight, -a.halfspacesLengthLimit) <
+               std::make_tuple(b.maxCapacityQNode, -b.maxLevelQTree, -b.limitHamWeight, -b.halfspacesLengthLimit);
+    });
+    size_t sample = std::min<size_t>(std::max(sampleSize, 1), order.size());
+    int rung = 0;
+
+    while (true) {
+        const size_t firstTrial = trials.size();
+        std::vector<std::vector<int>> ranks(candidates.size(), std::vector<int>(sample));
+        std::vector<std::vector<bool>> limited(candidates.size(), std::vector<bool>(sample, false));
+        double bestTime = std::numeric_limits<double>::infinity();  // fastest candidate that hit no limit
+
+        for (size_t c = 0; c < candidates.size(); c++) {
+            applyConfig(candidates[c]);
+            TuneTrial trial{rung, candidates[c], static_cast<int>(sample), 0.0, 0, 0, false};
+            const double budget = timeFactor * bestTime;
+            for (size_t i = 0; i < sample && !trial.timedOut; i++) {
+                queryTimeLimit = std::isfinite(budget) ? std::max(budget - trial.time, 1e-3) : 0.0;
+                const auto start = std::chrono::high_resolution_clock::now();
+                try {
+                    ranks[c][i] = aa_hd(data, data[order[i] - 1]).first;
+                } catch (const QueryTimeout&) {
+                    trial.timedOut = true;
+                }
+                const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+                trial.time += elapsed.count();
+                trial.limitsHit += queryMetrics.limitsHit;
+                limited[c][i] = queryMetrics.limitsHit > 0;
+            }
+            if (!trial.timedOut && trial.limitsHit == 0) bestTime = std::min(bestTime, trial.time);
+            trials.push_back(trial);
+        }
+
+        // Reference maxrank of each query: the best one among the runs that hit no limit.
+        // Truncated searches drop constraints and may report ranks that are not reachable,
+        // so a run that hit a limit on a query never counts as exact on it.
+        for (size_t i = 0; i < sample; i++) {
+            int best = std::numeric_limits<int>::max();
+            for (size_t c = 0; c < candidates.size(); c++) {
+                if (!trials[firstTrial + c].timedOut && !limited[c][i]) best = std::min(best, ranks[c][i]);
+            }
+            for (size_t c = 0; c < candidates.size(); c++) {
+                if (trials[firstTrial + c].timedOut) continue;
+                if (limited[c][i] || ranks[c][i] != best) trials[firstTrial + c].mismatches++;
+            }
+        }
+
+        std::vector<size_t> idx(candidates.size());
+        std::iota(idx.begin(), idx.end(), 0);
+        std::stable_sort(idx.begin(), idx.end(), [&](size_t a, size_t b) {
+            const TuneTrial& ta = trials[firstTrial + a];
+            const TuneTrial& tb = trials[firstTrial + b];
+            if (ta.timedOut != tb.timedOut) return tb.timedOut;
+            if (ta.mismatches != tb.mismatches) return ta.mismatches < tb.mismatches;
+            return ta.time < tb.time;
+        });
+
+        if (candidates.size() == 1 || (sample == order.size() && candidates.size() <= 3)) {
+            return candidates[idx[0]];
+        }
+
+        // Keep the best third (at least one) and triple the sample
+        const size_t keep = std::max<size_t>(1, (candidates.size() + 2) / 3);
+        std::vector<TuneConfig> survivors;
+        survivors.reserve(keep);
+        for (size_t k = 0; k < keep; k++) survivors.push_back(candidates[idx[k]]);
+        candidates = std::move(survivors);
+        sample = std::min(sample * 3, order.size());
+        rung++;
+    }
+}
+
+std::string tunedConfigPath(const std::string& datafile) {
+    const std::filesystem::path p(datafile);
+    return (p.parent_path() / (p.stem().string() + "_tuned_config.txt")).string();
+}
+
+void writeTunedConfig(const std::string& filename, const TuneConfig& config, const std::string& comment) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    size_t start = 0;
+    while (start < comment.size()) {
+        size_t end = comment.find('\n', start);
+        if (end == std::string::npos) end = comment.size();
+        file << "# " << comment.substr(start, end - start) << "\n";
+        start = end + 1;
+    }
+    file << "maxCapacityQNode=" << config.maxCapacityQNode << "\n"
+         << "maxLevelQTree=" << config.maxLevelQTree << "\n"
+         << "limitHamWeight=" << config.limitHamWeight << "\n"
+         << "halfspacesLengthLimit=" << config.halfspacesLengthLimit << "\n";
+}
+
+void writeTuneTrialsCSV(const std::string& filename, const std::vector<TuneTrial>& trials) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    file << "rung,maxCapacityQNode,maxLevelQTree,limitHamWeight,halfspacesLengthLimit,queries,time_s,limits_hit,mismatches,timed_out\n";
+    for (const auto& t : trials) {
+        file << t.rung << "," << t.config.maxCapacityQNode << "," << t.config.maxLevelQTree << ","
+             << t.config.limitHamWeight << "," << t.config.halfspacesLengthLimit << "," << t.queries << ","
+             << t.time << "," << t.limitsHit << "," << t.mismatches << "," << t.timedOut << "\n";
+    }
+}
@@ -0,0 +1,120 @@
+#include "batch2d.h"
+#include "config.h"
+#include "halfspace.h"
+#include <algorithm>
+#include <future>
+#include <limits>
+
+Batch2DEngine::Batch2DEngine(const std::vector<Point>& data) {
+    xs.reserve(data.size());
+    ys.reserve(data.size());
+    for (const auto& pt : data) {
+        xs.push_back(pt.coord[0]);
+        ys.push_back(pt.coord[1]);
+    }
+}
+
+Result2D Batch2DEngine::query(const Point& p, std::vector<std::pair<double, int>>& events) const {
+    const double px = p.coord[0];
+    const double py = p.coord[1];
+    const double pm = px - py;  // slope of p's line, as in HalfLine
+
+    events.clear();
+    int dominators = 0;
+    int order = 0;  // incomparables below p's line right after w1 = 0
+
+    for (size_t i = 0; i < xs.size(); ++i) {
+        const double x = xs[i];
+        const double y = ys[i];
+        if (x < px) {
+            // Either a dominator (y <= p.y) or an incomparable whose line
+            // starts above p's one and crosses below it at the intersection
+            if (y <= py) {
+                dominators++;
+            } else {
+                events.emplace_back((y - py) / (pm - (x - y)), +1);
+            }
+        } else if (x == px) {
+            // Only records strictly better on y dominate p
+            if (y < py) dominators++;
+        } else if (y < py) {
+            // An incomparable whose line starts below p's one ("coversleft")
+            events.emplace_back((y - py) / (pm - (x - y)), -1);
+            order++;
+        }
+    }
+
+    std::sort(events.begin(), events.end(), [](const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+
+    // Sweep w1 over [0,1]: between two consecutive intersections the number of
+    // incomparable lines below p is constant, keep the minimal open segments.
+    Result2D res{std::numeric_limits<int>::max(), {}};
+    auto visit = [&](double from, double to) {
+        if (!(to - from > halflineTieEps)) return;  // empty segment (coincident intersections)
+        if (order < res.maxrank) {
+            res.maxrank = order;
+            res.ranges.clear();
+            res.ranges.emplace_back(from, to);
+        } else if (order == res.maxrank) {
+            if (!res.ranges.empty() && res.ranges.back().second == from) {
+                res.ranges.back().second = to;
+            } else {
+                res.ranges.emplace_back(from, to);
+            }
+        }
+    };
+
+    double last_end = 0.0;
+    size_t e = 0;
+    while (e < events.size()) {
+        const double x = events[e].first;
+        visit(last_end, x);
+        while (e < events.size() && events[e].first == x) {
+            order += events[e].second;
+            e++;
+        }
+        last_end = std::max(last_end, x);
+    }
+    visit(last_end, 1.0);
+
+    res.maxrank += dominators + 1;
+    return res;
+}
+
+std::vector<Result2D> aa_2d_batch(const std::vector<Point>& data,
+                                  const std::vector<int>& queries)
+{
+    const Batch2DEngine engine(data);
+    std::vector<Result2D> results(queries.size());
+
+    const size_t totalQ = queries.size();
+    const unsigned int hwThreads = workerThreads();
+    const size_t chunkSize = (totalQ + hwThreads - 1) / hwThreads;
+
+    std::vector<std::future<void>> futures;
+    futures.reserve(hwThreads);
+
+    for (unsigned int t = 0; t < hwThreads; t++) {
+        size_t start = t * chunkSize;
+        if (start >= totalQ) break;
+        size_t end = std::min(start + chunkSize, totalQ);
+
+        futures.push_back(std::async(std::launch::async,
+            [&engine, &data, &queries, &results, start, end]()
+        {
+            // One event buffer per thread, reused by all of its queries
+            std::vector<std::pair<double, int>> events;
+            events.reserve(engine.size());
+            for (size_t i = start; i < end; ++i) {
+                results[i] = engine.query(data[queries[i] - 1], events);
+            }
+        }));
+    }
+
+    for (auto &f : futures) {
+        f.get();
+    }
+    return results;
+}
@@ -1,7 +1,11 @@
 #include "cell.h"
 #include "halfspace.h"
 #include "qtree.h"
+#include "maxrank.h"
+#include "metrics.h"
+#include "trace.h"
 #include <cmath>
+#include <algorithm>
 #include <bitset>
 #include <iostream>
 #include <limits>
@@ -49,9 +53,19 @@ Cell::Cell(const int order,
 {
 }
 
+std::vector<long> Cell::coveringHalfspaces() const {
+    std::vector<long> out(covered);
+    for (size_t b = 0; b < mask.size() && b < halfspaces.size(); ++b) {
+        if (mask[b] == '1') out.push_back(halfspaces[b]);
+    }
+    return out;
+}
+
 bool Cell::issingular() const {
-    // Checks if all halfspaces in 'covered' are SINGULAR
-    return std::all_of(covered.begin(), covered.end(),
+    // Checks if all halfspaces covering the cell are SINGULAR: an AUGMENTED one set in the
+    // mask still stands for the records it dominates, which may cover the cell too
+    const auto all = coveringHalfspaces();
+    return std::all_of(all.begin(), all.end(),
         [](long id) {
             return halfspaceCache->get(id)->arr == Arrangement::SINGULAR;
         }
@@ -126,6 +140,50 @@ std::vector<std::string> genhammingstrings(int strlen, int weight) {
     return results;
 }
 
+HammingStrings::HammingStrings(int strlen, int weight) : invert(false), done(false) {
+    // Stesse scelte di genhammingstrings: lunghezza limitata e inversione sopra metà lunghezza
+    if (strlen > halfspacesLengthLimit) {
+        strlen = halfspacesLengthLimit;
+    }
+    if (weight > strlen / 2) {
+        weight = strlen - weight;
+        invert = true;
+    }
+    // Peso 0: un'unica stringa di zeri, che genhammingstrings non inverte
+    if (weight == 0) {
+        invert = false;
+    }
+    this->strlen = strlen;
+    if (weight < 0) {
+        done = true;
+        return;
+    }
+    // Prima combinazione: gli 1 nelle prime posizioni
+    ones.resize(weight);
+    for (int i = 0; i < weight; ++i) ones[i] = i;
+}
+
+bool HammingStrings::next(std::vector<std::string>& out, const size_t count) {
+    out.clear();
+    const int weight = static_cast<int>(ones.size());
+    while (!done && out.size() < count) {
+        std::string bitpattern(strlen, invert ? '1' : '0');
+        for (const int i : ones) bitpattern[i] = invert ? '0' : '1';
+        out.push_back(std::move(bitpattern));
+
+        // Combinazione successiva in ordine lessicografico (lo stesso del backtracking)
+        int i = weight - 1;
+        while (i >= 0 && ones[i] == strlen - weight + i) --i;
+        if (i < 0) {
+            done = true;
+        } else {
+            ones[i]++;
+            for (int j = i + 1; j < weight; ++j) ones[j] = ones[j - 1] + 1;
+        }
+    }
+    return !out.empty();
+}
+
 /// -------------------------------------------------
 ///          HiGHS Utility Functions
 /// -------------------------------------------------
@@ -208,7 +266,8 @@ static LinprogResult* linprog_highs(const double* c,
     }
     result->fun = highs.getObjectiveValue();
     result->status = static_cast<int>(model_status);
-    strncpy(result->message, highs.modelStatusToString(model_status).c_str(), 128);
+    strncpy(result->message, highs.modelStatusToString(model_status).c_str(), sizeof(result->message) - 1);
+    result->message[sizeof(result->message) - 1] = '\0';
 
     return result;
 }
@@ -268,6 +327,7 @@ linprog_highs(const std::vector<double>& c,
 std::vector<Cell> searchmincells_lp(const QNode& leaf,
                                     const std::vector<std::string>& hamstrings)
 {
+    TRACE_SCOPE("searchmincells_lp", static_cast<long long>(hamstrings.size()));
     std::vector<Cell> cells;
     cells.reserve(hamstrings.size());
 
@@ -278,9 +338,17 @@ std::vector<Cell> searchmincells_lp(const QNode& leaf,
     // If no halfspaces, build a trivial cell from MBR center
     if (halfspaces.empty()) {
         std::vector<std::array<float, 2>> mbr = leaf.mbr;
+        // A leaf across sum(w) = 1 (binary QTree) takes the point at the same relative position
+        // on every side, halfway between its lowest corner and the hyperplane
+        double lowSum = 0.0, extent = 0.0;
+        for (int i = 0; i < dims; ++i) {
+            lowSum += mbr[i][0];
+            extent += mbr[i][1] - mbr[i][0];
+        }
+        const double t = extent > 0.0 ? std::min(0.5, 0.5 * (1.0 - lowSum) / extent) : 0.5;
         std::vector<double> center(dims);
         for (int i = 0; i < dims; ++i) {
-            center[i] = 0.5 * (mbr[i][0] + mbr[i][1]);
+            center[i] = t == 0.5 ? 0.5 * (mbr[i][0] + mbr[i][1]) : mbr[i][0] + t * (mbr[i][1] - mbr[i][0]);
         }
         Point feasible_pnt(center);
         return { Cell(0, "", leaf_covered, {}, mbr, feasible_pnt) };
@@ -307,7 +375,11 @@ std::vector<Cell> searchmincells_lp(const QNode& leaf,
     // Try each Hamming string
     int counterLoop = 0;
     for (const auto& hamstr : hamstrings) {
-        if (counterLoop++ > maxNoBinStringToCheck) return cells;
+        checkQueryDeadline();
+        if (counterLoop++ > maxNoBinStringToCheck) {
+            queryMetrics.limitsHit++;
+            return cells;
+        }
         // Set constraints according to the bitstring
         for (int b = 0; b < (int)hamstr.size(); ++b) {
             auto hs = halfspaceCache->get(halfspaces[b]);
@@ -327,10 +399,18 @@ std::vector<Cell> searchmincells_lp(const QNode& leaf,
         }
 
         // Solve the LP
-        auto [solution, fun, status, message] = linprog_highs(c, A_ub, b_ub, bounds);
+        std::tuple<std::vector<double>, double, int, std::string> lp;
+        {
+            TRACE_SCOPE("linprog_highs");
+            ScopedTimer lpTimer(queryMetrics.lpTime);
+            lp = linprog_highs(c, A_ub, b_ub, bounds);
+        }
+        queryMetrics.lpsSolved++;
+        auto& [solution, fun, status, message] = lp;
 
         // If feasible, build a Cell
         if (status == (int)HighsModelStatus::kOptimal) {
+            queryMetrics.lpsFeasible++;
             Point feasible_pnt(std::vector<double>(solution.begin(),
                                                    solution.end() - 1));
             cells.emplace_back(0, hamstr, leaf_covered,
@@ -342,3 +422,25 @@ std::vector<Cell> searchmincells_lp(const QNode& leaf,
 
     return cells;
 }
+
+std::vector<Cell> searchmincells_lp_chunked(const QNode& leaf, const int weight, size_t& generated) {
+    // Big enough to amortize the LP setup of searchmincells_lp over the chunk
+    constexpr size_t chunkSize = 4096;
+
+    HammingStrings gen(static_cast<int>(leaf.halfspaces.size()), weight);
+    std::vector<std::string> chunk;
+    generated = 0;
+    // searchmincells_lp tries at most maxNoBinStringToCheck + 1 strings
+    const size_t limit = static_cast<size_t>(maxNoBinStringToCheck) + 1;
+    while (generated < limit && gen.next(chunk, std::min(chunkSize, limit - generated))) {
+        generated += chunk.size();
+        std::vector<Cell> cells = searchmincells_lp(leaf, chunk);
+        if (!cells.empty()) return cells;
+    }
+    // One more string means searchmincells_lp would have stopped at its limit
+    if (generated == limit && gen.next(chunk, 1)) {
+        generated++;
+        queryMetrics.limitsHit++;
+    }
+    return {};
+}
@@ -0,0 +1,228 @@
+#include "config.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <thread>
+
+/**
+ * Global defaults for optional parameters.
+ */
+int limitHamWeight = 999;
+int maxLevelQTree = 99;
+int maxCapacityQNode = 10;
+int qtreeSplit = 0;
+int splitPosition = 0;
+int maxNoBinStringToCheck = 999999;
+int halfspacesLengthLimit = 21;
+int sweep2D = 0;
+int numThreads = 0;
+int quietMode = 0;
+int perfCounters = 0;
+int explainMode = 0;
+int autotuneMode = 0;
+int autotuneSample = 4;
+int useTunedConfig = 1;
+std::string resultCacheDir;
+int rankThreshold = 0;
+int boundSamples = 256;
+int dominanceIndex = 1;
+int resumeMode = 0;
+int flushEvery = 16;
+int memoryBudget = 0;
+std::string serverSocket;
+int serverWorkers = 4;
+int serverQueue = 16;
+
+unsigned int workerThreads() {
+    if (numThreads > 0) return static_cast<unsigned int>(numThreads);
+    return std::max(1U, std::thread::hardware_concurrency());
+}
+
+void parseArgs(int argc, char* argv[], int firstFlag) {
+    // Required parameters come first: datafile, numRecords, dimensions, numQueries, queryfile, outputDir
+    // We parse them by position, then parse optional flags from index firstFlag onward.
+    // e.g. --limit-ham-weight=500
+    for (int i = firstFlag; i < argc; i++) {
+        std::string arg = argv[i];
+        // Identify flags of the form "--key=value"
+        if (arg.rfind("--", 0) == 0) {
+            // Find '=' sign
+            size_t eqPos = arg.find('=');
+            if (eqPos == std::string::npos) {
+                std::cerr << "Ignoring invalid flag: " << arg << std::endl;
+                continue;
+            }
+            std::string key = arg.substr(2, eqPos - 2);    // e.g. "limit-ham-weight"
+            std::string val = arg.substr(eqPos + 1);       // e.g. "500"
+
+            try {
+                if (key == "limit-ham-weight") {
+                    limitHamWeight = std::stoi(val);
+                } else if (key == "max-level-qtree") {
+                    maxLevelQTree = std::stoi(val);
+                } else if (key == "max-capacity-qnode") {
+                    maxCapacityQNode = std::stoi(val);
+                } else if (key == "qtree-split") {
+                    qtreeSplit = std::stoi(val);
+                } else if (key == "split-position") {
+                    splitPosition = std::stoi(val);
+                } else if (key == "max-nobinstring-to-check") {
+                    maxNoBinStringToCheck = std::stoi(val);
+                } else if (key == "halfspaces-length-limit") {
+                    halfspacesLengthLimit = std::stoi(val);
+                } else if (key == "sweep-2d") {
+                    sweep2D = std::stoi(val);
+                } else if (key == "num-threads") {
+                    numThreads = std::stoi(val);
+                } else if (key == "quiet") {
+                    quietMode = std::stoi(val);
+                } else if (key == "perf-counters") {
+                    perfCounters = std::stoi(val);
+                } else if (key == "explain") {
+                    explainMode = std::stoi(val);
+                } else if (key == "autotune") {
+                    autotuneMode = std::stoi(val);
+                } else if (key == "autotune-sample") {
+                    autotuneSample = std::stoi(val);
+                } else if (key == "use-tuned-config") {
+                    useTunedConfig = std::stoi(val);
+                } else if (key == "result-cache") {
+                    resultCacheDir = val;
+                } else if (key == "rank-threshold") {
+                    rankThreshold = std::stoi(val);
+                } else if (key == "bound-samples") {
+                    boundSamples = std::stoi(val);
+                } else if (key == "dominance-index") {
+                    dominanceIndex = std::stoi(val);
+                } else if (key == "resume") {
+                    resumeMode = std::stoi(val);
+                } else if (key == "flush-every") {
+                    flushEvery = std::stoi(val);
+                } else if (key == "memory-budget") {
+                    memoryBudget = std::stoi(val);
+                } else if (key == "server-socket") {
+                    serverSocket = val;
+                } else if (key == "server-workers") {
+                    serverWorkers = std::stoi(val);
+                } else if (key == "server-queue") {
+                    serverQueue = std::stoi(val);
+                } else {
+                    std::cerr << "Unknown parameter: --" << key << std::endl;
+                }
+            } catch (const std::invalid_argument&) {
+                std::cerr << "Invalid integer value in flag: " << arg << std::endl;
+            } catch (const std::out_of_range&) {
+                std::cerr << "Out-of-range integer value in flag: " << arg << std::endl;
+            }
+        } else {
+            std::cerr << "Ignoring unrecognized argument: " << arg << std::endl;
+        }
+    }
+
+    // Validate optional parameters
+    if (limitHamWeight < 0 || maxLevelQTree < 1 ||
+        maxCapacityQNode < 1 || maxNoBinStringToCheck < 1 ||
+        halfspacesLengthLimit < 1 || numThreads < 0 || autotuneSample < 1 ||
+        serverWorkers < 1 || serverQueue < 0 || flushEvery < 1 || rankThreshold < 0 || boundSamples < 0 ||
+        qtreeSplit < 0 || qtreeSplit > 2 || splitPosition < 0 || splitPosition > 1 || memoryBudget < 0)
+    {
+        throw std::runtime_error("One or more optional parameters are invalid (<=0).");
+    }
+}
+
+void parseConfigFile(const std::string& configFile) {
+    // Convert to an absolute path if not already
+    std::filesystem::path configPath(configFile);
+    if (!configPath.is_absolute()) {
+        configPath = std::filesystem::absolute(configPath);
+    }
+
+    std::ifstream in(configPath);
+    if (!in.is_open()) {
+        throw std::runtime_error("Could not open config file: " + configPath.string());
+    }
+    std::string line;
+    while (std::getline(in, line)) {
+        // skip empty lines or comments
+        if (line.empty() || line[0] == '#') continue;
+        size_t eqPos = line.find('=');
+        if (eqPos == std::string::npos) continue;
+
+        std::string key = line.substr(0, eqPos);
+        std::string val = line.substr(eqPos + 1);
+
+        try {
+            if (key == "limitHamWeight") {
+                limitHamWeight = std::stoi(val);
+            } else if (key == "maxLevelQTree") {
+                maxLevelQTree = std::stoi(val);
+            } else if (key == "maxCapacityQNode") {
+                maxCapacityQNode = std::stoi(val);
+            } else if (key == "qtreeSplit") {
+                qtreeSplit = std::stoi(val);
+            } else if (key == "splitPosition") {
+                splitPosition = std::stoi(val);
+            } else if (key == "maxNoBinStringToCheck") {
+                maxNoBinStringToCheck = std::stoi(val);
+            } else if (key == "halfspacesLengthLimit") {
+                halfspacesLengthLimit = std::stoi(val);
+            } else if (key == "sweep2D") {
+                sweep2D = std::stoi(val);
+            } else if (key == "numThreads") {
+                numThreads = std::stoi(val);
+            } else if (key == "quietMode") {
+                quietMode = std::stoi(val);
+            } else if (key == "perfCounters") {
+                perfCounters = std::stoi(val);
+            } else if (key == "explainMode") {
+                explainMode = std::stoi(val);
+            } else if (key == "autotuneMode") {
+                autotuneMode = std::stoi(val);
+            } else if (key == "autotuneSample") {
+                autotuneSample = std::stoi(val);
+            } else if (key == "useTunedConfig") {
+                useTunedConfig = std::stoi(val);
+            } else if (key == "resultCacheDir") {
+                resultCacheDir = val;
+            } else if (key == "rankThreshold") {
+                rankThreshold = std::stoi(val);
+            } else if (key == "boundSamples") {
+                boundSamples = std::stoi(val);
+            } else if (key == "dominanceIndex") {
+                dominanceIndex = std::stoi(val);
+            } else if (key == "resumeMode") {
+                resumeMode = std::stoi(val);
+            } else if (key == "flushEvery") {
+                flushEvery = std::stoi(val);
+            } else if (key == "memoryBudget") {
+                memoryBudget = std::stoi(val);
+            } else if (key == "serverSocket") {
+                serverSocket = val;
+            } else if (key == "serverWorkers") {
+                serverWorkers = std::stoi(val);
+            } else if (key == "serverQueue") {
+                serverQueue = std::stoi(val);
+            } else {
+                std::cerr << "Unknown config key: " << key << std::endl;
+            }
+        } catch (const std::invalid_argument&) {
+            std::cerr << "Invalid integer value for key " << key << " in config file.\n";
+        } catch (const std::out_of_range&) {
+            std::cerr << "Out-of-range integer value for key " << key << " in config file.\n";
+        }
+    }
+
+    in.close();
+
+    // Validate again
+    if (limitHamWeight < 0 || maxLevelQTree < 1 ||
+        maxCapacityQNode < 1 || maxNoBinStringToCheck < 1 ||
+        halfspacesLengthLimit < 1 || numThreads < 0 || autotuneSample < 1 ||
+        serverWorkers < 1 || serverQueue < 0 || flushEvery < 1 || rankThreshold < 0 || boundSamples < 0 ||
+        qtreeSplit < 0 || qtreeSplit > 2 || splitPosition < 0 || splitPosition > 1 || memoryBudget < 0)
+    {
+        throw std::runtime_error("Invalid config file parameter (<=0).");
+    }
+}
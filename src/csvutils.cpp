@@ -1,7 +1,11 @@
 #include "csvutils.h"
 
+#include <algorithm>
+#include <filesystem>
 #include <iomanip>
 #include <iostream>
+#include <sstream>
+#include <unordered_map>
 
 std::vector<Point> readCSV(const std::string& filename, int numRecords, int dimensions) {
     std::ifstream file(filename);
@@ -72,13 +76,47 @@ std::vector<int> readQuery(const std::string& filename, int numQueries) {
         }
     }
 
-    if (query.size() != numQueries) {
+    if (query.size() != static_cast<size_t>(numQueries)) {
         throw std::runtime_error("Query file does not contain the expected number of queries.");
     }
 
     return query;
 }
 
+void writeDataCSV(const std::string& filename, const std::vector<Point>& data) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    file << std::setprecision(17);
+
+    // Header: id,x1,x2,...
+    file << "id";
+    const int dims = data.empty() ? 0 : data.front().dims;
+    for (int d = 1; d <= dims; ++d) {
+        file << ",x" << d;
+    }
+    file << "\n";
+
+    for (const auto& p : data) {
+        file << p.id;
+        for (const double c : p.coord) {
+            file << "," << c;
+        }
+        file << "\n";
+    }
+}
+
+void writeQuery(const std::string& filename, const std::vector<int>& query) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    for (const int q : query) {
+        file << q << "\n";
+    }
+}
+
 template <typename T>
 void writeCSV(const std::string& filename, const std::vector<std::vector<T>>& data, const std::vector<std::string>& headers) {
     std::ofstream file(filename);
@@ -110,6 +148,112 @@ void writeCSV(const std::string& filename, const std::vector<std::vector<T>>& da
     }
 }
 
+namespace {
+
+void writeHeaders(std::ostream& out, const std::vector<std::string>& headers) {
+    for (size_t i = 0; i < headers.size(); ++i) {
+        out << headers[i] << (i < headers.size() - 1 ? "," : "");
+    }
+    out << "\n";
+}
+
+// Newline-terminated data rows of a CSV file (header skipped), with the id of their first column
+std::vector<std::pair<int, std::string>> readCompleteRows(const std::string& filename) {
+    std::vector<std::pair<int, std::string>> rows;
+    std::ifstream file(filename, std::ios::binary);
+    if (!file.is_open()) return rows;
+
+    const std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    size_t start = content.find('\n');  // skip the header
+    if (start == std::string::npos) return rows;
+    start++;
+    size_t eol;
+    while ((eol = content.find('\n', start)) != std::string::npos) {
+        const std::string line = content.substr(start, eol - start);
+        start = eol + 1;
+        try {
+            // The cells file writes the id as a double ("12.000000000000000")
+            rows.emplace_back(static_cast<int>(std::stod(line.substr(0, line.find(',')))), line);
+        } catch (const std::exception&) {
+            // not a result row
+        }
+    }
+    return rows;
+}
+
+// Replaces a file through a temporary, so that a crash while resuming leaves the old file
+void rewriteRows(const std::string& filename, const std::vector<std::string>& headers,
+                 const std::vector<std::pair<int, std::string>>& rows, const std::unordered_set<int>& keep) {
+    const std::string tmp = filename + ".tmp";
+    {
+        std::ofstream out(tmp, std::ios::binary);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not open file: " + tmp);
+        }
+        writeHeaders(out, headers);
+        for (const auto& [id, line] : rows) {
+            if (keep.count(id)) out << line << "\n";
+        }
+    }
+    std::filesystem::rename(tmp, filename);
+}
+
+} // namespace
+
+CSVStreamWriter::CSVStreamWriter(const std::string& filename, const std::vector<std::string>& headers,
+                                 const bool append, const int flushEvery)
+    : flushEvery(std::max(flushEvery, 1)), lastFlush(std::chrono::steady_clock::now())
+{
+    const bool continuing = append && std::filesystem::exists(filename);
+    file.open(filename, continuing ? std::ios::app : std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+    // Same formatting as writeCSV: fixed 15 decimals for doubles, ints unaffected
+    file << std::fixed << std::setprecision(15);
+    if (!continuing) {
+        writeHeaders(file, headers);
+        file.flush();
+    }
+}
+
+void CSVStreamWriter::flush() {
+    file.flush();
+    pending = 0;
+    lastFlush = std::chrono::steady_clock::now();
+}
+
+std::unordered_set<int> resumeResultCSVs(const std::string& maxrankFile, const std::string& cellsFile,
+                                         const std::vector<std::string>& maxrankHeaders,
+                                         const std::vector<std::string>& cellsHeaders) {
+    const auto maxrankRows = readCompleteRows(maxrankFile);
+    const auto cellsRows = readCompleteRows(cellsFile);
+
+    std::unordered_set<int> withCells;
+    for (const auto& row : cellsRows) withCells.insert(row.first);
+    std::unordered_set<int> done;
+    for (const auto& row : maxrankRows) {
+        if (withCells.count(row.first)) done.insert(row.first);
+    }
+
+    rewriteRows(maxrankFile, maxrankHeaders, maxrankRows, done);
+    rewriteRows(cellsFile, cellsHeaders, cellsRows, done);
+    return done;
+}
+
+void resumeQueryCSV(const std::string& filename, const std::unordered_set<int>& done) {
+    std::vector<std::string> headers;
+    {
+        std::ifstream file(filename);
+        std::string header;
+        if (!file.is_open() || !std::getline(file, header)) return;
+        std::istringstream ss(header);
+        std::string name;
+        while (std::getline(ss, name, ',')) headers.push_back(name);
+    }
+    rewriteRows(filename, headers, readCompleteRows(filename), done);
+}
+
 // Explicit Template Instantiations
 template void writeCSV<int>(const std::string&, const std::vector<std::vector<int>>&, const std::vector<std::string>&);
 template void writeCSV<double>(const std::string&, const std::vector<std::vector<double>>&, const std::vector<std::string>&);
\ No newline at end of file
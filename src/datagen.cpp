@@ -0,0 +1,64 @@
+#include "datagen.h"
+#include <algorithm>
+#include <random>
+#include <stdexcept>
+
+Distribution parseDistribution(const std::string& name) {
+    if (name == "independent" || name == "ind") return Distribution::INDEPENDENT;
+    if (name == "correlated" || name == "cor") return Distribution::CORRELATED;
+    if (name == "anticorrelated" || name == "anti") return Distribution::ANTICORRELATED;
+    throw std::invalid_argument("Unknown data distribution: " + name);
+}
+
+std::string distributionName(const Distribution dist) {
+    switch (dist) {
+        case Distribution::INDEPENDENT:    return "ind";
+        case Distribution::CORRELATED:     return "cor";
+        case Distribution::ANTICORRELATED: return "anti";
+    }
+    return "ind";
+}
+
+std::vector<Point> gendata(const Distribution dist, const int numRecords, const int dims, const unsigned int seed) {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> unif(0.0, 1.0);
+    std::normal_distribution<double> center(0.5, 0.25);
+    std::normal_distribution<double> spread(0.0, 0.05);
+
+    std::vector<Point> data;
+    data.reserve(numRecords);
+    std::vector<double> coord(dims);
+
+    // Same recipe as the classic skyline benchmark generator (Borzsonyi et al.):
+    // records are rejected and redrawn until every attribute falls in [0,1].
+    for (int id = 1; id <= numRecords; ++id) {
+        bool inside = false;
+        while (!inside) {
+            switch (dist) {
+                case Distribution::INDEPENDENT:
+                    for (auto& c : coord) c = unif(gen);
+                    break;
+                case Distribution::CORRELATED: {
+                    const double v = center(gen);
+                    for (auto& c : coord) c = v + spread(gen);
+                    break;
+                }
+                case Distribution::ANTICORRELATED: {
+                    // Spread uniformly, then shift the record on a plane sum(x) = dims * v
+                    const double v = 0.5 + spread(gen);
+                    double mean = 0.0;
+                    for (auto& c : coord) {
+                        c = unif(gen);
+                        mean += c;
+                    }
+                    mean /= dims;
+                    for (auto& c : coord) c += v - mean;
+                    break;
+                }
+            }
+            inside = std::all_of(coord.begin(), coord.end(), [](double c) { return c >= 0.0 && c <= 1.0; });
+        }
+        data.emplace_back(coord, id);
+    }
+    return data;
+}
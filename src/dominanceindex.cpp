@@ -0,0 +1,138 @@
+#include "dominanceindex.h"
+#include <algorithm>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+const DominanceIndex* activeDominanceIndex = nullptr;
+
+namespace {
+
+constexpr size_t maxBuckets = 64;
+
+int popcount(const uint64_t w) {
+#if defined(_MSC_VER)
+    return static_cast<int>(__popcnt64(w));
+#else
+    return __builtin_popcountll(w);
+#endif
+}
+
+int lowestBit(const uint64_t w) {
+#if defined(_MSC_VER)
+    unsigned long i;
+    _BitScanForward64(&i, w);
+    return static_cast<int>(i);
+#else
+    return __builtin_ctzll(w);
+#endif
+}
+
+} // namespace
+
+DominanceIndex::DominanceIndex(const std::vector<Point>& data)
+    : source(&data), n(data.size()), words((data.size() + 63) / 64),
+      dims(data.empty() ? 0 : data.front().dims), lower(dims), upTo(dims)
+{
+    std::vector<double> values(n);
+    std::vector<uint64_t> acc(words);
+    for (int d = 0; d < dims; d++) {
+        for (size_t i = 0; i < n; i++) values[i] = data[i].coord[d];
+        std::sort(values.begin(), values.end());
+
+        // Quantile lower bounds, deduplicated so that equal values share a bucket
+        auto& lo = lower[d];
+        for (size_t b = 0; b < maxBuckets; b++) {
+            const double v = values[b * n / maxBuckets];
+            if (lo.empty() || v > lo.back()) lo.push_back(v);
+        }
+
+        // Records of each bucket, then prefix unions
+        std::vector<std::vector<uint64_t>> members(lo.size(), std::vector<uint64_t>(words, 0));
+        for (size_t i = 0; i < n; i++) {
+            const size_t b = std::upper_bound(lo.begin(), lo.end(), data[i].coord[d]) - lo.begin() - 1;
+            members[b][i / 64] |= uint64_t{1} << (i % 64);
+        }
+        std::fill(acc.begin(), acc.end(), 0);
+        upTo[d].reserve(lo.size());
+        for (const auto& m : members) {
+            for (size_t w = 0; w < words; w++) acc[w] |= m[w];
+            upTo[d].push_back(acc);
+        }
+    }
+}
+
+DominancePartition DominanceIndex::partition(const Point& p) const {
+    DominancePartition part;
+    if (n == 0) return part;
+
+    // Per dimension: records strictly below p's bucket (lt) and up to p's bucket (le);
+    // nullptr stands for the empty set
+    std::vector<const uint64_t*> lt(dims), le(dims);
+    for (int d = 0; d < dims; d++) {
+        const auto& lo = lower[d];
+        const long b = static_cast<long>(std::upper_bound(lo.begin(), lo.end(), p.coord[d]) - lo.begin()) - 1;
+        lt[d] = b > 0 ? upTo[d][b - 1].data() : nullptr;
+        le[d] = b >= 0 ? upTo[d][b].data() : nullptr;
+    }
+
+    const std::vector<Point>& data = *source;
+    for (size_t w = 0; w < words; w++) {
+        const uint64_t valid = (w + 1 < words || n % 64 == 0) ? ~uint64_t{0} : (uint64_t{1} << (n % 64)) - 1;
+        uint64_t allLess = valid, allGreater = valid;   // strictly below / above p in every dimension
+        uint64_t someLess = 0, someGreater = 0;         // strictly below / above p in some dimension
+        uint64_t sameBucket = 0;                        // in p's bucket in some dimension
+        for (int d = 0; d < dims; d++) {
+            const uint64_t less = lt[d] ? lt[d][w] : 0;
+            const uint64_t upToP = le[d] ? le[d][w] : 0;
+            const uint64_t greater = ~upToP & valid;
+            allLess &= less;
+            allGreater &= greater;
+            someLess |= less;
+            someGreater |= greater;
+            sameBucket |= upToP & ~less;
+        }
+        part.dominators += popcount(allLess);
+        part.dominees += popcount(allGreater);
+        uint64_t incomparable = someLess & someGreater;
+
+        // The rest of the shared-bucket records need their coordinates
+        uint64_t check = sameBucket & ~incomparable & valid;
+        while (check) {
+            const int bit = lowestBit(check);
+            check &= check - 1;
+            const Point& r = data[w * 64 + bit];
+            bool less = false, greater = false;
+            for (int d = 0; d < dims; d++) {
+                less |= r.coord[d] < p.coord[d];
+                greater |= r.coord[d] > p.coord[d];
+            }
+            if (less && greater) incomparable |= uint64_t{1} << bit;
+            else if (less) part.dominators++;
+            else if (greater) part.dominees++;
+        }
+
+        while (incomparable) {
+            part.incomparables.push_back(w * 64 + lowestBit(incomparable));
+            incomparable &= incomparable - 1;
+        }
+    }
+    return part;
+}
+
+size_t DominanceIndex::bytes() const {
+    size_t total = 0;
+    for (int d = 0; d < dims; d++) {
+        total += lower[d].capacity() * sizeof(double);
+        for (const auto& bitmap : upTo[d]) total += bitmap.capacity() * sizeof(uint64_t);
+    }
+    return total;
+}
+
+DominancePartition partitionRecords(const std::vector<Point>& data, const Point& p) {
+    if (activeDominanceIndex && activeDominanceIndex->covers(data)) {
+        return activeDominanceIndex->partition(p);
+    }
+    return getpartition(data, p);
+}
@@ -0,0 +1,212 @@
+#include "dynamic.h"
+#include "maxrank.h"
+#include "metrics.h"
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+namespace {
+
+// Scores closer than this are treated as ties (same tolerance as the witness checks)
+constexpr double scoreEps = 1e-9;
+
+enum class Relation { DOMINATOR, INCOMPARABLE, OTHER };
+
+// Position of r with respect to p, as in getdominators / getincomparables
+Relation relation(const Point& r, const Point& p) {
+    bool less = false, greater = false;
+    for (int i = 0; i < p.dims; i++) {
+        if (r.coord[i] < p.coord[i]) less = true;
+        if (r.coord[i] > p.coord[i]) greater = true;
+    }
+    if (less && greater) return Relation::INCOMPARABLE;
+    if (less) return Relation::DOMINATOR;
+    return Relation::OTHER;
+}
+
+// Score of r minus score of p under w (negative: r ranks above p)
+double scoreGap(const Point& r, const Point& p, const std::vector<double>& w) {
+    double gap = 0.0;
+    for (int i = 0; i < p.dims; i++) gap += w[i] * (r.coord[i] - p.coord[i]);
+    return gap;
+}
+
+int countDominators(const std::vector<Point>& data, const Point& p) {
+    int count = 0;
+    for (const auto& r : data) {
+        if (relation(r, p) == Relation::DOMINATOR) count++;
+    }
+    return count;
+}
+
+} // namespace
+
+DynamicDataset::DynamicDataset(std::vector<Point> data) : data(std::move(data)) {
+    reindex();
+}
+
+void DynamicDataset::reindex() {
+    index.clear();
+    index.reserve(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        if (!index.emplace(data[i].id, i).second) {
+            throw std::invalid_argument("Duplicate record id: " + std::to_string(data[i].id));
+        }
+        nextId = std::max(nextId, data[i].id + 1);
+    }
+}
+
+const Point* DynamicDataset::record(const int id) const {
+    const auto it = index.find(id);
+    return it == index.end() ? nullptr : &data[it->second];
+}
+
+TrackedQuery DynamicDataset::compute(const std::vector<Point>& data, const Point& p) {
+    TrackedQuery t;
+    t.dominators = countDominators(data, p);
+    if (p.dims > 2) {
+        auto [maxrank, mincells] = aa_hd(data, p);
+        t.result.maxrank = maxrank;
+        t.budgetHit = queryMetrics.memoryBudgetHit;
+        for (const auto& cell : mincells) {
+            std::vector<double> w = cell.feasible_pnt.coord;
+            w.push_back(1 - std::accumulate(w.begin(), w.end(), 0.0));
+            t.witnesses.push_back(std::move(w));
+        }
+        // Same witness as the cells file: the first minimal cell
+        if (!t.witnesses.empty()) t.result.witness = t.witnesses.front();
+    } else {
+        auto [maxrank, mincells] = aa_2d(data, p);
+        t.result.maxrank = maxrank;
+        for (const auto& cell : mincells) {
+            t.result.witness.push_back(cell.range.first);
+            t.result.witness.push_back(cell.range.second);
+        }
+    }
+    return t;
+}
+
+const TrackedQuery& DynamicDataset::query(const int id) {
+    const Point* p = record(id);
+    if (!p) {
+        throw std::invalid_argument("No record with id " + std::to_string(id));
+    }
+    auto it = queries.find(id);
+    if (it != queries.end() && !it->second.stale) return it->second;
+    if (it != queries.end() && !it->second.budgetHit) updates.recomputed++;
+    TrackedQuery& t = queries[id];
+    t = compute(data, *p);
+    // A degraded result is not exact: the updates must not maintain it, the next query recomputes it
+    t.stale = t.budgetHit;
+    return t;
+}
+
+const TrackedQuery* DynamicDataset::cached(const int id) const {
+    const auto it = queries.find(id);
+    return (it == queries.end() || it->second.stale) ? nullptr : &it->second;
+}
+
+void DynamicDataset::adopt(const int id, const CachedResult& result) {
+    const Point* p = record(id);
+    if (!p) {
+        throw std::invalid_argument("No record with id " + std::to_string(id));
+    }
+    TrackedQuery t;
+    t.result = result;
+    t.dominators = countDominators(data, *p);
+    // For d > 2 the cells-file witness is a full weight vector
+    if (p->dims > 2 && static_cast<int>(result.witness.size()) == p->dims) t.witnesses.push_back(result.witness);
+    queries[id] = std::move(t);
+}
+
+int DynamicDataset::insert(const std::vector<double>& coord, int id) {
+    if (!data.empty() && coord.size() != data.front().coord.size()) {
+        throw std::invalid_argument("Expected " + std::to_string(data.front().coord.size()) + " coordinates");
+    }
+    if (id < 0) id = nextId;
+    if (index.count(id)) {
+        throw std::invalid_argument("Record id already in use: " + std::to_string(id));
+    }
+    data.emplace_back(coord, id);
+    index[id] = data.size() - 1;
+    nextId = std::max(nextId, id + 1);
+    updates.inserts++;
+
+    const Point& r = data.back();
+    for (auto& [qid, t] : queries) {
+        if (t.stale) continue;
+        const Point& p = data[index[qid]];
+        switch (relation(r, p)) {
+            case Relation::DOMINATOR:
+                t.result.maxrank++;
+                t.dominators++;
+                updates.shifted++;
+                break;
+            case Relation::INCOMPARABLE: {
+                // The maxrank stays reachable wherever p still scores clearly better than r
+                std::vector<std::vector<double>> kept;
+                for (auto& w : t.witnesses) {
+                    if (scoreGap(r, p, w) >= scoreEps) kept.push_back(std::move(w));
+                }
+                t.witnesses = std::move(kept);
+                if (t.witnesses.empty()) {
+                    t.stale = true;
+                    updates.invalidated++;
+                } else {
+                    t.result.witness = t.witnesses.front();
+                    updates.unaffected++;
+                }
+                break;
+            }
+            case Relation::OTHER:
+                updates.unaffected++;
+                break;
+        }
+    }
+    return id;
+}
+
+void DynamicDataset::remove(const int id) {
+    const auto it = index.find(id);
+    if (it == index.end()) {
+        throw std::invalid_argument("No record with id " + std::to_string(id));
+    }
+    const Point r = data[it->second];
+    data.erase(data.begin() + static_cast<std::ptrdiff_t>(it->second));
+    reindex();
+    updates.deletes++;
+    if (queries.erase(id)) updates.dropped++;
+
+    for (auto& [qid, t] : queries) {
+        if (t.stale) continue;
+        const Point& p = data[index[qid]];
+        switch (relation(r, p)) {
+            case Relation::DOMINATOR:
+                t.result.maxrank--;
+                t.dominators--;
+                updates.shifted++;
+                break;
+            case Relation::INCOMPARABLE:
+                // Already ranked right after its dominators: nothing left to gain
+                if (t.result.maxrank == t.dominators + 1) {
+                    updates.unaffected++;
+                } else {
+                    t.stale = true;
+                    updates.invalidated++;
+                }
+                break;
+            case Relation::OTHER:
+                updates.unaffected++;
+                break;
+        }
+    }
+}
+
+size_t DynamicDataset::refresh() {
+    std::vector<int> stale;
+    for (const auto& [qid, t] : queries) {
+        if (t.stale) stale.push_back(qid);
+    }
+    for (const int qid : stale) query(qid);
+    return stale.size();
+}
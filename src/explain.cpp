@@ -0,0 +1,89 @@
+#include "explain.h"
+#include "qtree.h"
+#include <algorithm>
+
+std::vector<ExplainCycle> queryExplain;
+
+void explainQTree(const QTree& qt, ExplainCycle& out) {
+    out.macroRootsTotal = static_cast<int>(qt.macroRoots.size());
+    out.macroRootsPopulated = 0;
+    out.nodesPerLevel.clear();
+    out.leavesPerLevel.clear();
+    out.leafHalfspaces.clear();
+
+    for (const QNode* sr : qt.macroRoots) {
+        if (!sr) continue;
+        out.macroRootsPopulated++;
+
+        std::vector<const QNode*> stack = {sr};
+        while (!stack.empty()) {
+            const QNode* node = stack.back();
+            stack.pop_back();
+
+            const auto level = static_cast<size_t>(std::max(node->level, 0));
+            if (out.nodesPerLevel.size() <= level) {
+                out.nodesPerLevel.resize(level + 1, 0);
+                out.leavesPerLevel.resize(level + 1, 0);
+            }
+            out.nodesPerLevel[level]++;
+
+            if (node->leaf) {
+                out.leavesPerLevel[level]++;
+                out.leafHalfspaces[node->halfspaces.size()]++;
+            } else {
+                for (const QNode* child : node->children) {
+                    if (child) stack.push_back(child);
+                }
+            }
+        }
+    }
+}
+
+namespace {
+
+template <typename T>
+void writeArray(std::ostream& out, const std::vector<T>& values) {
+    out << "[";
+    for (size_t i = 0; i < values.size(); i++) {
+        out << (i ? "," : "") << values[i];
+    }
+    out << "]";
+}
+
+// Histograms become JSON objects with the bucket as (string) key
+template <typename K>
+void writeHistogram(std::ostream& out, const std::map<K, size_t>& hist) {
+    out << "{";
+    bool first = true;
+    for (const auto& [key, count] : hist) {
+        out << (first ? "" : ",") << "\"" << key << "\":" << count;
+        first = false;
+    }
+    out << "}";
+}
+
+} // namespace
+
+void writeExplainJSON(std::ostream& out, const int queryId, const std::vector<ExplainCycle>& cycles) {
+    for (const auto& c : cycles) {
+        out << "{\"id\":" << queryId
+            << ",\"cycle\":" << c.cycle
+            << ",\"macro_roots_populated\":" << c.macroRootsPopulated
+            << ",\"macro_roots_total\":" << c.macroRootsTotal
+            << ",\"nodes_per_level\":";
+        writeArray(out, c.nodesPerLevel);
+        out << ",\"leaves_per_level\":";
+        writeArray(out, c.leavesPerLevel);
+        out << ",\"leaf_halfspaces_hist\":";
+        writeHistogram(out, c.leafHalfspaces);
+        out << ",\"leaves\":" << c.leaves
+            << ",\"leaves_searched\":" << c.leavesSearched
+            << ",\"leaves_pruned\":" << c.leavesPruned
+            << ",\"leaves_cut_off\":" << c.leavesCutOff
+            << ",\"hamweight_reached_hist\":";
+        writeHistogram(out, c.hamweightReached);
+        out << ",\"mincells\":" << c.mincells
+            << ",\"halfspaces_to_expand\":" << c.halfspacesToExpand
+            << "}\n";
+    }
+}
@@ -9,142 +9,27 @@
 #include "maxrank.h"
 #include "qtree.h"
 #include "cell.h"
+#include "batch2d.h"
+#include "autotune.h"
+#include "config.h"
+#include "dominanceindex.h"
+#include "explain.h"
+#include "metrics.h"
+#include "perfcounters.h"
+#include "resultcache.h"
+#include "trace.h"
 #include <chrono>
 #include <csvutils.h>
 #include <filesystem>
+#include <memory>
 
 using namespace std;
 
-/**
- * Global defaults for optional parameters.
- */
-int limitHamWeight = 999;
-int maxLevelQTree = 99;
-int maxCapacityQNode = 10;
-int maxNoBinStringToCheck = 999999;
-int halfspacesLengthLimit = 21;
-
 std::string getBaseFilename(const std::string& path) {
     std::filesystem::path p(path);
     return p.stem().string(); // Get filename without extension
 }
 
-/**
- * \brief Parses command-line flags of the form --flag=value
- *        and updates the global variables accordingly.
- *
- * \param argc Number of CLI arguments
- * \param argv Array of argument strings
- */
-void parseArgs(int argc, char* argv[]) {
-    // Required parameters come first: datafile, numRecords, dimensions, numQueries, queryfile, outputDir
-    // We parse them by position, then parse optional flags from index 7 onward.
-    // e.g. --limit-ham-weight=500
-    for (int i = 7; i < argc; i++) {
-        std::string arg = argv[i];
-        // Identify flags of the form "--key=value"
-        if (arg.rfind("--", 0) == 0) {
-            // Find '=' sign
-            size_t eqPos = arg.find('=');
-            if (eqPos == std::string::npos) {
-                std::cerr << "Ignoring invalid flag: " << arg << std::endl;
-                continue;
-            }
-            std::string key = arg.substr(2, eqPos - 2);    // e.g. "limit-ham-weight"
-            std::string val = arg.substr(eqPos + 1);       // e.g. "500"
-
-            try {
-                if (key == "limit-ham-weight") {
-                    limitHamWeight = std::stoi(val);
-                } else if (key == "max-level-qtree") {
-                    maxLevelQTree = std::stoi(val);
-                } else if (key == "max-capacity-qnode") {
-                    maxCapacityQNode = std::stoi(val);
-                } else if (key == "max-nobinstring-to-check") {
-                    maxNoBinStringToCheck = std::stoi(val);
-                } else if (key == "halfspaces-length-limit") {
-                    halfspacesLengthLimit = std::stoi(val);
-                } else {
-                    std::cerr << "Unknown parameter: --" << key << std::endl;
-                }
-            } catch (const std::invalid_argument&) {
-                std::cerr << "Invalid integer value in flag: " << arg << std::endl;
-            } catch (const std::out_of_range&) {
-                std::cerr << "Out-of-range integer value in flag: " << arg << std::endl;
-            }
-        } else {
-            std::cerr << "Ignoring unrecognized argument: " << arg << std::endl;
-        }
-    }
-
-    // Validate optional parameters
-    if (limitHamWeight < 0 || maxLevelQTree < 1 ||
-        maxCapacityQNode < 1 || maxNoBinStringToCheck < 1 ||
-        halfspacesLengthLimit < 1)
-    {
-        throw std::runtime_error("One or more optional parameters are invalid (<=0).");
-    }
-}
-
-/**
- * \brief (Optional) Reads a config file to set the global parameters.
- *        Format: Each line as key=value (like limitHamWeight=999).
- *
- * \param configFile Path to the configuration file.
- */
-void parseConfigFile(const std::string& configFile) {
-    // Convert to an absolute path if not already
-    std::filesystem::path configPath(configFile);
-    if (!configPath.is_absolute()) {
-        configPath = std::filesystem::absolute(configPath);
-    }
-
-    std::ifstream in(configPath);
-    if (!in.is_open()) {
-        throw std::runtime_error("Could not open config file: " + configPath.string());
-    }
-    std::string line;
-    while (std::getline(in, line)) {
-        // skip empty lines or comments
-        if (line.empty() || line[0] == '#') continue;
-        size_t eqPos = line.find('=');
-        if (eqPos == std::string::npos) continue;
-
-        std::string key = line.substr(0, eqPos);
-        std::string val = line.substr(eqPos + 1);
-
-        try {
-            if (key == "limitHamWeight") {
-                limitHamWeight = std::stoi(val);
-            } else if (key == "maxLevelQTree") {
-                maxLevelQTree = std::stoi(val);
-            } else if (key == "maxCapacityQNode") {
-                maxCapacityQNode = std::stoi(val);
-            } else if (key == "maxNoBinStringToCheck") {
-                maxNoBinStringToCheck = std::stoi(val);
-            } else if (key == "halfspacesLengthLimit") {
-                halfspacesLengthLimit = std::stoi(val);
-            } else {
-                std::cerr << "Unknown config key: " << key << std::endl;
-            }
-        } catch (const std::invalid_argument&) {
-            std::cerr << "Invalid integer value for key " << key << " in config file.\n";
-        } catch (const std::out_of_range&) {
-            std::cerr << "Out-of-range integer value for key " << key << " in config file.\n";
-        }
-    }
-
-    in.close();
-
-    // Validate again
-    if (limitHamWeight < 0 || maxLevelQTree < 1 ||
-        maxCapacityQNode < 1 || maxNoBinStringToCheck < 1 ||
-        halfspacesLengthLimit < 1)
-    {
-        throw std::runtime_error("Invalid config file parameter (<=0).");
-    }
-}
-
 int main(const int argc, char* argv[]) {
 
     // Start execution timer
@@ -161,6 +46,15 @@ int main(const int argc, char* argv[]) {
                   << "  --max-capacity-qnode=20\n"
                   << "  --max-nobinstring-to-check=999999\n"
                   << "  --halfspaces-length-limit=21\n"
+                  << "  --sweep-2d=1\n"
+                  << "  --num-threads=0\n"
+                  << "  --quiet=1\n"
+                  << "  --perf-counters=1\n"
+                  << "  --explain=1\n"
+                  << "  --autotune=1 --autotune-sample=4 --use-tuned-config=1\n"
+                  << "  --result-cache=<dir>\n"
+                  << "  --resume=1 --flush-every=16\n"
+                  << "  --rank-threshold=10\n"
                   << std::endl;
         return 1;
     }
@@ -186,25 +80,41 @@ int main(const int argc, char* argv[]) {
     }
 
     // 6th parameter could be a config file or a series of --flag=value arguments
-    if (argc >= 8) {  // Ensure there's a 6th argument
-        std::string arg7 = argv[7];
-
-        // Convert to absolute path if it looks like a file path
-        std::filesystem::path configPath(arg7);
-        if (std::filesystem::exists(configPath) && std::filesystem::is_regular_file(configPath)) {
-            try {
-                parseConfigFile(configPath.string());  // Load config file
-            } catch (const std::exception& e) {
-                std::cerr << "Error loading config file: " << e.what() << "\n";
+    auto applyOptionalArgs = [&]() {
+        if (argc >= 8) {  // Ensure there's a 6th argument
+            std::string arg7 = argv[7];
+
+            // Convert to absolute path if it looks like a file path
+            std::filesystem::path configPath(arg7);
+            if (std::filesystem::exists(configPath) && std::filesystem::is_regular_file(configPath)) {
+                try {
+                    parseConfigFile(configPath.string());  // Load config file
+                } catch (const std::exception& e) {
+                    std::cerr << "Error loading config file: " << e.what() << "\n";
+                }
+            } else if (arg7.rfind("--", 0) == 0) {
+                // If it starts with "--", assume it's a CLI argument and parse it
+                parseArgs(argc, argv);
+            } else {
+                std::cerr << "Ignoring unrecognized argument: " << arg7 << std::endl;
             }
-        } else if (arg7.rfind("--", 0) == 0) {
-            // If it starts with "--", assume it's a CLI argument and parse it
+        } else if (argc > 7) {
             parseArgs(argc, argv);
-        } else {
-            std::cerr << "Ignoring unrecognized argument: " << arg7 << std::endl;
         }
-    } else if (argc > 7) {
-        parseArgs(argc, argv);
+    };
+    applyOptionalArgs();
+
+    // The tuned config of the dataset (written by --autotune=1) sits below the explicit
+    // config file / flags: load it, then re-apply them so that they keep precedence.
+    const std::string tunedPath = tunedConfigPath(datafile);
+    if (useTunedConfig && !autotuneMode && std::filesystem::exists(tunedPath)) {
+        try {
+            parseConfigFile(tunedPath);
+            applyOptionalArgs();
+            std::cout << "Using tuned config: " << tunedPath << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Error loading tuned config file: " << e.what() << "\n";
+        }
     }
 
     std::cout << "\n========================[ PARAMS SUMMARY ]========================\n";
@@ -218,8 +128,29 @@ int main(const int argc, char* argv[]) {
     std::cout << "   limitHamWeight:          " << limitHamWeight << "\n";
     std::cout << "   maxLevelQTree:           " << maxLevelQTree << "\n";
     std::cout << "   maxCapacityQNode:        " << maxCapacityQNode << "\n";
+    std::cout << "   qtreeSplit:              " << qtreeSplit << "\n";
+    std::cout << "   splitPosition:           " << splitPosition << "\n";
     std::cout << "   maxNoBinStringToCheck:   " << maxNoBinStringToCheck << "\n";
-    std::cout << "   halfspacesLengthLimit:   " << halfspacesLengthLimit << "\n\n";
+    std::cout << "   halfspacesLengthLimit:   " << halfspacesLengthLimit << "\n";
+    std::cout << "   sweep2D:                 " << sweep2D << "\n";
+    std::cout << "   numThreads:              " << numThreads << "\n";
+    std::cout << "   quietMode:               " << quietMode << "\n";
+    std::cout << "   perfCounters:            " << perfCounters << "\n";
+    std::cout << "   explainMode:             " << explainMode << "\n";
+    std::cout << "   autotuneMode:            " << autotuneMode << "\n";
+    std::cout << "   resultCacheDir:          " << (resultCacheDir.empty() ? "(disabled)" : resultCacheDir) << "\n";
+    std::cout << "   rankThreshold:           " << rankThreshold << "\n";
+    std::cout << "   boundSamples:            " << boundSamples << "\n";
+    std::cout << "   dominanceIndex:          " << dominanceIndex << "\n";
+    std::cout << "   resumeMode:              " << resumeMode << "\n";
+    std::cout << "   flushEvery:              " << flushEvery << "\n";
+    std::cout << "   memoryBudget:            " << (memoryBudget > 0 ? std::to_string(memoryBudget) + " MB" : "(none)") << "\n\n";
+    std::cout << "Available Memory:    " << getAvailableMemory() / (1024 * 1024) << " MB\n\n";
+
+    // Open the counters here, so that every worker thread created later inherits them
+    if (perfCounters && !openPerfCounters()) {
+        std::cerr << "Hardware performance counters are not available, reporting wall time only." << std::endl;
+    }
 
     // Load dataset
     vector<Point> data = readCSV(datafile, numRecords, dimensions);
@@ -229,68 +160,230 @@ int main(const int argc, char* argv[]) {
     vector<int> query = readQuery(queryfile, numQueries);
     cout << "Loaded " << query.size() << " queries from " << queryfile << endl;
 
-    // Main MaxRank routine
-    vector<vector<int>> res;
-    res.reserve(query.size());
-    vector<vector<double>> cells;
-    cells.reserve(query.size());
+    const std::string baseFilename = getBaseFilename(datafile) + getBaseFilename(queryfile);
+
+    // Autotune: search the parameters on a sample of the queries, save them for later runs
+    // of the same dataset and use them for this run too
+    if (autotuneMode && dimensions > 2) {
+        cout << "Autotuning on samples of the " << query.size() << " queries..." << endl;
+        const auto tuneStart = std::chrono::high_resolution_clock::now();
+        vector<TuneTrial> trials;
+        const TuneConfig best = autotune(data, query, autotuneGrid(dimensions), autotuneSample, 42, 3.0, trials);
+        const std::chrono::duration<double> tuneTime = std::chrono::high_resolution_clock::now() - tuneStart;
+
+        writeTunedConfig(tunedPath, best,
+                         "Tuned by --autotune=1 for " + datafile + " (" + std::to_string(dimensions) + "D)\n" +
+                         std::to_string(trials.size()) + " trials in " + std::to_string(tuneTime.count()) + " s");
+        writeTuneTrialsCSV((std::filesystem::path(outdir) / ("autotune_" + baseFilename + ".csv")).string(), trials);
+        parseConfigFile(tunedPath);
+        cout << "Tuned config written to " << tunedPath << ": maxCapacityQNode=" << maxCapacityQNode
+             << " maxLevelQTree=" << maxLevelQTree << " limitHamWeight=" << limitHamWeight
+             << " halfspacesLengthLimit=" << halfspacesLengthLimit << endl;
+    }
+
+    // Result cache: opened after autotuning, its key includes the parameters actually used.
+    // 2D queries are answered exactly even in decision mode, so they share the exact results.
+    const std::string engine = dimensions > 2 ? "hd" : (sweep2D ? "2d-sweep" : "2d");
+    std::unique_ptr<ResultCache> cache;
+    if (!resultCacheDir.empty()) {
+        cache = std::make_unique<ResultCache>(resultCacheDir, hashDataset(data), resultCacheParams(engine, dimensions > 2 ? rankThreshold : 0));
+        cout << "Result cache " << cache->path() << ": " << cache->size() << " results" << endl;
+    }
+    int cacheHits = 0;
+    int budgetHits = 0;
+
+    std::filesystem::path outPathMaxrank = std::filesystem::path(outdir) / ("maxrank_" + baseFilename + ".csv");
+    std::filesystem::path outPathCells   = std::filesystem::path(outdir) / ("cells_"   + baseFilename + ".csv");
+    std::filesystem::path outPathMetrics = std::filesystem::path(outdir) / ("metrics_" + baseFilename + ".csv");
+    std::filesystem::path outPathMemory  = std::filesystem::path(outdir) / ("memory_"  + baseFilename + ".csv");
+    // Decision mode: the rank column is a bound (<= k with a witness if reachable, > k if not)
+    vector<string> maxrankHeaders = rankThreshold > 0 ? vector<string>{ "id", "rank_bound", "reachable" }
+                                                       : vector<string>{ "id", "maxrank" };
+    // With a memory budget, a degraded result (an upper bound of the MaxRank) is flagged in its row
+    if (memoryBudget > 0) maxrankHeaders.emplace_back("degraded");
+    const vector<string> cellsHeaders = { "id", "query_found" };
+
+    // Resume: keep the results already in the output files and skip their queries
+    if (resumeMode) {
+        const auto done = resumeResultCSVs(outPathMaxrank.string(), outPathCells.string(), maxrankHeaders, cellsHeaders);
+        // Metrics rows are written unbuffered: those of queries whose result was lost are dropped
+        resumeQueryCSV(outPathMetrics.string(), done);
+        resumeQueryCSV(outPathMemory.string(), done);
+        vector<int> remaining;
+        for (const int q : query) {
+            if (!done.count(q)) remaining.push_back(q);
+        }
+        cout << "Resuming: " << query.size() - remaining.size() << " of " << query.size()
+             << " queries already in " << outPathMaxrank.string() << endl;
+        query = std::move(remaining);
+    }
+
+    // Main MaxRank routine: results are streamed to the output files as the queries complete
+    CSVStreamWriter maxrankOut(outPathMaxrank.string(), maxrankHeaders, resumeMode, flushEvery);
+    CSVStreamWriter cellsOut(outPathCells.string(), cellsHeaders, resumeMode, flushEvery);
+    bool metricsStarted = false;
+
+    // Saves the result of a query (cell_entry without the id) and stores it in the cache
+    auto saveResult = [&](const int q, const int maxrank, const vector<double>& witness, const bool computed) {
+        vector cell_entry = { static_cast<double>(q) };
+        cell_entry.insert(cell_entry.end(), witness.begin(), witness.end());
+        // cells first: on resume, a maxrank row only counts when its cells row is there too
+        cellsOut.writeRow(cell_entry);
+        const bool degraded = computed && queryMetrics.memoryBudgetHit;
+        vector<int> row = rankThreshold > 0 ? vector<int>{q, maxrank, maxrank <= rankThreshold ? 1 : 0}
+                                            : vector<int>{q, maxrank};
+        if (memoryBudget > 0) row.push_back(degraded ? 1 : 0);
+        maxrankOut.writeRow(row);
+        // A query degraded by the memory budget is not worth caching
+        if (cache && !degraded && computed) cache->store(q, {maxrank, witness});
+    };
+
+    // Explain output is streamed query by query: it is still there if a query runs out of memory
+    std::ofstream explainFile;
+    if (explainMode && dimensions > 2) {
+        const std::filesystem::path outPathExplain = std::filesystem::path(outdir) / ("explain_" + baseFilename + ".jsonl");
+        explainFile.open(outPathExplain, resumeMode ? std::ios::app : std::ios::trunc);
+        if (!explainFile.is_open()) {
+            std::cerr << "Could not open explain file: " << outPathExplain.string() << std::endl;
+            return 1;
+        }
+    }
+
+    // Dominance index: built once, it replaces the scan of the dataset at every query. Its build
+    // costs tens of scans, so only runs with enough queries to recoup it build one.
+    std::unique_ptr<DominanceIndex> domIndex;
+    if (dominanceIndex && query.size() >= dominanceIndexMinQueries && (dimensions > 2 || !sweep2D)) {
+        const auto indexStart = std::chrono::high_resolution_clock::now();
+        domIndex = std::make_unique<DominanceIndex>(data);
+        activeDominanceIndex = domIndex.get();
+        const std::chrono::duration<double> indexTime = std::chrono::high_resolution_clock::now() - indexStart;
+        cout << "Dominance index built in " << indexTime.count() << " seconds ("
+             << static_cast<double>(domIndex->bytes()) / (1024.0 * 1024.0) << " MB)" << endl;
+    }
 
     if (dimensions > 2) {
         for (const int q : query) {
-            cout << "#  Processing data point " << q << "  #" << endl;
             const int idx = q - 1;
-
-            cout << "#  " << Eigen::Map<Eigen::VectorXd>(data[idx].coord.data(), data[idx].coord.size()).transpose() << "  #" << endl;
+            CachedResult hit;
+            if (cache && cache->lookup(q, hit)) {
+                cacheHits++;
+                if (!quietMode) cout << "#  Data point " << q << ": MaxRank " << hit.maxrank << " (cached)  #" << endl;
+                saveResult(q, hit.maxrank, hit.witness, false);
+                continue;
+            }
+            if (!quietMode) {
+                cout << "#  Processing data point " << q << "  #" << '\n';
+                cout << "#  " << Eigen::Map<Eigen::VectorXd>(data[idx].coord.data(), data[idx].coord.size()).transpose() << "  #" << '\n';
+            }
 
             int maxrank;
             vector<Cell> mincells;
-            tie(maxrank, mincells) = aa_hd(data, data[idx]);
+            const bool peakReset = resetPeakMemory();
+            {
+                TRACE_SCOPE("query", q);
+                tie(maxrank, mincells) = aa_hd(data, data[idx], rankThreshold);
+            }
+            if (peakReset) queryMetrics.peakRssBytes = getPeakMemory();
+            if (explainFile.is_open()) {
+                writeExplainJSON(explainFile, q, queryExplain);
+                explainFile.flush();
+            }
 
-            cout << "#  MaxRank: " << maxrank << "  NOfMincells: " << mincells.size() << "  #" << endl;
+            if (!quietMode) cout << "#  MaxRank: " << maxrank << "  NOfMincells: " << mincells.size() << "  #" << endl;
+            if (queryMetrics.memoryBudgetHit) {
+                budgetHits++;
+                if (!quietMode) cout << "#  Memory budget hit: the QTree stopped splitting, the MaxRank may be an upper bound  #" << endl;
+            }
 
             // Saving results
-            res.push_back({q, maxrank});
-            vector cell_entry = { static_cast<double>(q) };
+            vector<double> witness;
             for (const auto &cell : mincells)
             {
-                cell_entry.insert(cell_entry.end(), cell.feasible_pnt.coord.begin(), cell.feasible_pnt.coord.end());
-                cell_entry.push_back(1 - accumulate(cell.feasible_pnt.coord.begin(), cell.feasible_pnt.coord.end(), 0.0));
+                witness.insert(witness.end(), cell.feasible_pnt.coord.begin(), cell.feasible_pnt.coord.end());
+                witness.push_back(1 - accumulate(cell.feasible_pnt.coord.begin(), cell.feasible_pnt.coord.end(), 0.0));
 
                 break;
             }
-            cells.push_back(cell_entry);
+            saveResult(q, maxrank, witness, true);
+
+            // Metrics are streamed too, after the result: on resume they continue the files of the interrupted run
+            const MetricsRecord record{q, maxrank, queryMetrics};
+            writeMetricsCSV(outPathMetrics.string(), {record}, resumeMode || metricsStarted);
+            writeMemoryCSV(outPathMemory.string(), {record}, resumeMode || metricsStarted);
+            metricsStarted = true;
+        }
+    } else if (sweep2D) {
+        // Only the queries missing from the cache go through the sweep
+        vector<int> toCompute;
+        for (const int q : query) {
+            CachedResult hit;
+            if (!cache || !cache->lookup(q, hit)) toCompute.push_back(q);
+        }
+
+        vector<Result2D> results;
+        if (!toCompute.empty()) results = aa_2d_batch(data, toCompute);
+        cout << "#  Processed " << results.size() << " queries with the 2D sweep  #" << endl;
+
+        size_t next = 0;
+        for (const int q : query) {
+            CachedResult hit;
+            if (next < toCompute.size() && toCompute[next] == q) {
+                // Saving results
+                vector<double> witness;
+                for (const auto &range : results[next].ranges) {
+                    witness.push_back(range.first);
+                    witness.push_back(range.second);
+                }
+                saveResult(q, results[next].maxrank, witness, true);
+                next++;
+            } else {
+                cache->lookup(q, hit);
+                cacheHits++;
+                saveResult(q, hit.maxrank, hit.witness, false);
+            }
         }
     } else {
         for (const int q : query) {
-            cout << "#  Processing data point " << q << "  #" << endl;
             const int idx = q - 1;
-
-            cout << "#  " << Eigen::Map<Eigen::VectorXd>(data[idx].coord.data(), data[idx].coord.size()).transpose() << "  #" << endl;
+            CachedResult hit;
+            if (cache && cache->lookup(q, hit)) {
+                cacheHits++;
+                if (!quietMode) cout << "#  Data point " << q << ": MaxRank " << hit.maxrank << " (cached)  #" << endl;
+                saveResult(q, hit.maxrank, hit.witness, false);
+                continue;
+            }
+            if (!quietMode) {
+                cout << "#  Processing data point " << q << "  #" << '\n';
+                cout << "#  " << Eigen::Map<Eigen::VectorXd>(data[idx].coord.data(), data[idx].coord.size()).transpose() << "  #" << '\n';
+            }
 
             int maxrank;
             vector<Interval> mincells;
             tie(maxrank, mincells) = aa_2d(data, data[idx]);
 
-            cout << "#  MaxRank: " << maxrank << "  NOfMincells: " << mincells.size() << "  #" << endl;
+            if (!quietMode) cout << "#  MaxRank: " << maxrank << "  NOfMincells: " << mincells.size() << "  #" << endl;
 
             // Saving results
-            res.push_back({q, maxrank});
-            vector<double> cell_entry = { static_cast<double>(q) };
+            vector<double> witness;
             for (const auto &cell : mincells) {
-                cell_entry.push_back(cell.range.first);
-                cell_entry.push_back(cell.range.second);
+                witness.push_back(cell.range.first);
+                witness.push_back(cell.range.second);
             }
-            cells.push_back(cell_entry);
+            saveResult(q, maxrank, witness, true);
         }
     }
-
-    std::string baseFilename = getBaseFilename(datafile) + getBaseFilename(queryfile);
-    std::filesystem::path outPathMaxrank = std::filesystem::path(outdir) / ("maxrank_" + baseFilename + ".csv");
-    std::filesystem::path outPathCells   = std::filesystem::path(outdir) / ("cells_"   + baseFilename + ".csv");
-
-    // Write results to CSV
-    writeCSV(outPathMaxrank.string(), res, { "id", "maxrank" });
-    writeCSV(outPathCells.string(), cells, { "id", "query_found" });
+    activeDominanceIndex = nullptr;
+    if (budgetHits > 0) cout << "Memory budget: " << budgetHits << " of " << query.size() << " queries hit the "
+                             << memoryBudget << " MB budget and degraded" << endl;
+    if (cache) cout << "Result cache: " << cacheHits << " of " << query.size() << " queries answered from the cache" << endl;
+
+    maxrankOut.flush();
+    cellsOut.flush();
+    if (traceEnabled) {
+        const std::filesystem::path outPathTrace = std::filesystem::path(outdir) / ("trace_" + baseFilename + ".json");
+        writeTrace(outPathTrace.string());
+        cout << "Trace written to " << outPathTrace.string() << endl;
+    }
 
     // Print execution time
     const auto end = std::chrono::high_resolution_clock::now();
@@ -1,35 +1,120 @@
 #include "maxrank.h"
-
+#include "config.h"
+#include "dominanceindex.h"
+#include "explain.h"
+#include "membudget.h"
+#include "memstats.h"
+#include "metrics.h"
+#include "sampling.h"
+#include "trace.h"
+
+#include <chrono>
+#include <numeric>
+#include <stdexcept>
 #include <unordered_set>
 
 int numOfSubdivisions = 0;
+double queryTimeLimit = 0.0;
+
+namespace {
+std::chrono::steady_clock::time_point queryDeadline;
+
+// Sampled weights are the same for every query, so results are reproducible
+constexpr unsigned int boundSeed = 42;
+// Near ties count against p: the sampled rank then holds in a neighbourhood of the weights
+constexpr double boundTieEps = 1e-9;
+}
+
+void checkQueryDeadline() {
+    if (queryTimeLimit > 0.0 && std::chrono::steady_clock::now() > queryDeadline) {
+        throw QueryTimeout("Query exceeded the time limit of " + std::to_string(queryTimeLimit) + " seconds");
+    }
+}
 
 // Definisci e inizializza le variabili globali
 HalfSpaceCache* halfspaceCache = nullptr;
 std::unordered_map<Point, long, PointHash> pointToHalfSpaceCache;
 
-std::pair<int, std::vector<Cell>> aa_hd(const std::vector<Point>& data, const Point& p) {
+std::pair<int, std::vector<Cell>> aa_hd(const std::vector<Point>& data, const Point& p, const int rankThreshold) {
+
+    TRACE_SCOPE("aa_hd", p.id);
+    queryMetrics.reset();
+    queryExplain.clear();
+    queryBudget.start();
+    ScopedTimer totalTimer(queryMetrics.totalTime);
+    if (queryTimeLimit > 0.0) {
+        queryDeadline = std::chrono::steady_clock::now() +
+                        std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(queryTimeLimit));
+    }
 
-    // Reset global variables
+    // Reset global variables (the cache of the previous query is no longer referenced)
+    delete halfspaceCache;
     halfspaceCache = nullptr;
     pointToHalfSpaceCache.clear();
 
     int dims = static_cast<int>(p.dims - 1);
     numOfSubdivisions = (int) pow(2.0, dims);
-    float queryPlane[10];
-    // Imposta queryPlane in modo fisso a 1
-    for (int i = 0; i < dims + 1; i++) {
-        queryPlane[i] = 1.0f;
+
+    QTree qt(dims, maxCapacityQNode, maxLevelQTree, static_cast<QTreeSplit>(qtreeSplit),
+             static_cast<SplitPosition>(splitPosition));
+    int dominatorCount;
+    std::vector<Point> incomp;
+    {
+        TRACE_SCOPE("partition");
+        ScopedPhase phase(Phase::DOMINANCE);
+        const DominancePartition part = partitionRecords(data, p);
+        dominatorCount = static_cast<int>(part.dominators);
+        incomp.reserve(part.incomparables.size());
+        for (const size_t i : part.incomparables) incomp.push_back(data[i]);
+    }
+
+    // Decision mode: rank <= rankThreshold needs a cell of order <= maxOrder. Leaves and
+    // Hamming weights above it are never searched, and the dominators may settle it alone.
+    int maxOrder = std::numeric_limits<int>::max();
+    if (rankThreshold > 0) {
+        if (dominatorCount >= rankThreshold) {
+            return {dominatorCount + 1, {}};
+        }
+        maxOrder = rankThreshold - dominatorCount - 1;
     }
-    std::vector<std::string> Comb = readCombinations(dims);
-    for (int i = 0; i < dims + 1; i++) queryPlane[i] = 1;
 
-    QTree qt(dims, maxCapacityQNode, maxLevelQTree);
-    std::vector<Point> dominators = getdominators(data, p);
-    std::vector<Point> incomp = getincomparables(data, p);
+    // Sampled upper bound: no cell of a higher order can be the answer, so from the first
+    // cycle the leaf search is capped by it as if a cell of that order had been found
+    std::vector<Cell> sampledCells;
+    int sampledOrder = std::numeric_limits<int>::max();
+    if (boundSamples > 0) {
+        TRACE_SCOPE("sampledBound", static_cast<long long>(incomp.size()));
+        ScopedPhase phase(Phase::SAMPLING);
+        const RankSampler sampler(incomp, p.dims);
+        const SampledRank best = sampler.best(p, sampleSimplexWeights(p.dims, boundSamples, boundSeed), boundTieEps);
+        sampledOrder = best.below;
+        queryMetrics.sampledBound = dominatorCount + sampledOrder + 1;
+        // Cells keep the first dims weights, the last one is 1 - their sum
+        const std::vector<double> w(best.weights.begin(), best.weights.end() - 1);
+        sampledCells.emplace_back(sampledOrder, std::string(), std::vector<long>(), std::vector<long>(),
+                                  std::vector<std::array<float, 2>>(), Point(w));
+
+        // Order 0 cannot be improved; in decision mode any bound within the threshold settles it
+        if (sampledOrder == 0 || (rankThreshold > 0 && sampledOrder <= maxOrder)) {
+            return {queryMetrics.sampledBound, sampledCells};
+        }
+        maxOrder = std::min(maxOrder, sampledOrder);
+    }
+
+    // k-skyband prefilter: wherever an incomparable with more than maxOrder incomparable
+    // dominators beats p, at least maxOrder + 1 records of the band beat it too, so no
+    // cell of order <= maxOrder can involve it
+    if (maxOrder < std::numeric_limits<int>::max()) {
+        TRACE_SCOPE("kskyband", static_cast<long long>(incomp.size()));
+        ScopedPhase phase(Phase::DOMINANCE);
+        const size_t before = incomp.size();
+        incomp = getkskyband(incomp, maxOrder + 1);
+        queryMetrics.skybandPruned = static_cast<long>(before - incomp.size());
+    }
 
     // Inizializzo la cache per gli halfspaces
     initializeCache(data.size());
+    qt.maxSearchedOrder = static_cast<size_t>(maxOrder);
 
     std::unordered_set<long> incompIDs;
     incompIDs.reserve(incomp.size());
@@ -37,42 +122,64 @@ std::pair<int, std::vector<Cell>> aa_hd(const std::vector<Point>& data, const Po
         incompIDs.insert(pt.id);
     }
 
+    // Nodes outside the simplex the last insertion did not create (children and macro sub-MBRs)
+    size_t insertPruned = 0;
     auto updateqt = [&](const std::vector<Point>& old_sky) {
-        std::cout << "> getting skyline ... " << std::endl;
+        if (!quietMode) std::cout << "> getting skyline ... " << '\n';
         auto start = std::chrono::high_resolution_clock::now();
-        std::vector<Point> new_sky = getskyline(incomp);
+        std::vector<Point> new_sky;
+        {
+            TRACE_SCOPE("getskyline", static_cast<long long>(incomp.size()));
+            ScopedPhase phase(Phase::SKYLINE);
+            new_sky = getskyline(incomp);
+        }
         auto end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> elapsed = end - start;
-        std::cout << "> skyline time: " << elapsed.count() << " seconds.\n" << std::endl;
-
-        std::vector<long> new_halfspaces = genhalfspaces(p, new_sky);
-        std::vector<long> unique_new_halfspaces;
-        for (const auto& hs : new_halfspaces) {
-            bool found = false;
-            for (const auto& os : old_sky) {
-                if (os.id == hs) {
-                    found = true;
-                    break;
+        queryMetrics.skylineTime += elapsed.count();
+        if (!quietMode) std::cout << "> skyline time: " << elapsed.count() << " seconds.\n" << '\n';
+
+        std::vector<long> new_halfspaces;
+        {
+            TRACE_SCOPE("genhalfspaces", static_cast<long long>(new_sky.size()));
+            ScopedPhase phase(Phase::HALFSPACES);
+            new_halfspaces = genhalfspaces(p, new_sky);
+            std::vector<long> unique_new_halfspaces;
+            for (const auto& hs : new_halfspaces) {
+                bool found = false;
+                for (const auto& os : old_sky) {
+                    if (os.id == hs) {
+                        found = true;
+                        break;
+                    }
+                }
+                if (!found) {
+                    unique_new_halfspaces.push_back(hs);
                 }
             }
-            if (!found) {
-                unique_new_halfspaces.push_back(hs);
-            }
-        }
 
-        new_halfspaces = std::move(unique_new_halfspaces);
+            new_halfspaces = std::move(unique_new_halfspaces);
+        }
 
         start = std::chrono::high_resolution_clock::now();
-        std::cout << "> " << new_halfspaces.size() << " halfspace(s) to insert" << std::endl;
-        if (!new_halfspaces.empty()) {
+        if (!quietMode) std::cout << "> " << new_halfspaces.size() << " halfspace(s) to insert" << '\n';
+        {
+            // An empty first batch still fixes the macro split and creates the macro-roots
+            ScopedPhase phase(Phase::INSERT);
             //qt.inserthalfspaces(new_halfspaces);
             qt.inserthalfspacesMacroSplit(new_halfspaces);
+        }
+        insertPruned = qt.nodesPruned.exchange(0, std::memory_order_relaxed);
+        queryMetrics.leavesPruned += static_cast<long>(insertPruned);
+        if (!new_halfspaces.empty()) {
             end = std::chrono::high_resolution_clock::now();
             elapsed = end - start;
-            std::cout << "> " << new_halfspaces.size() << " halfspace(s) have been inserted in " << elapsed.count() << " seconds." << std::endl;
+            queryMetrics.insertTime += elapsed.count();
+            queryMetrics.halfspacesInserted += static_cast<long>(new_halfspaces.size());
+            if (!quietMode) std::cout << "> " << new_halfspaces.size() << " halfspace(s) have been inserted in " << elapsed.count() << " seconds." << '\n';
         }
 
 
+        TRACE_SCOPE("collectLeaves");
         auto new_leaves = qt.getAllLeaves();//qt.getLeaves();
         //std::cout << "> " << new_leaves.size() << " total leaves" << std::endl;
         qt.updateAllOrders();
@@ -89,59 +196,162 @@ std::pair<int, std::vector<Cell>> aa_hd(const std::vector<Point>& data, const Po
     std::vector<Cell> mincells_singular;
     int n_exp = 0;
 
+    // Memory budget: close to the limit the query degrades instead of growing. The QTree stops
+    // splitting, the leaves that will not be searched again (of an order above maxOrder /
+    // minorder_singular, which can only drop while the orders grow) free their halfspaces,
+    // and the leaf search becomes "lean"
+    bool leanSearch = false;
+    auto governMemory = [&](const std::vector<QNode*>& currLeaves, const size_t trackedBytes) {
+        if (!queryBudget.enabled()) return;
+        if (!queryMetrics.memoryBudgetHit && !qt.splitsFrozen && !queryBudget.near(trackedBytes)) return;
+        if (!queryMetrics.memoryBudgetHit && !quietMode) {
+            std::cout << "> Memory budget of " << memoryBudget << " MB almost reached: degrading the query" << '\n';
+        }
+        queryMetrics.memoryBudgetHit = true;
+        qt.splitsFrozen = true;
+        leanSearch = true;
+        const size_t bound = static_cast<size_t>(std::min(maxOrder, minorder_singular));
+        qt.maxSearchedOrder = bound;
+        const size_t keep = static_cast<size_t>(halfspacesLengthLimit) + 1;
+        for (auto* leaf : currLeaves) {
+            if (leaf->order > bound) {
+                leaf->clearHalfspaces();
+            } else if (leaf->halfspaces.size() > keep) {
+                // The search never reads past halfspacesLengthLimit: one more is enough to flag the truncation
+                leaf->halfspaces.resize(keep);
+                leaf->halfspaces.shrink_to_fit();
+            }
+        }
+    };
+    governMemory(leaves, 0);
+
+    // After a search cut short by the limits, the mask of a leaf covers only its first
+    // halfspacesLengthLimit halfspaces, so the order of a cell can be underestimated. The true
+    // rank at the witness (dominators excluded) is counted instead: an upper bound of the MaxRank
+    const auto truncatedOrders = [&]() { return queryMetrics.limitsHit > 0; };
+    const auto witnessOrder = [&](const Cell& witness) {
+        std::vector<double> w = witness.feasible_pnt.coord;
+        w.push_back(1.0 - std::accumulate(w.begin(), w.end(), 0.0));
+        const DominancePartition part = partitionRecords(data, p);
+        std::vector<Point> all;
+        all.reserve(part.incomparables.size());
+        for (const size_t i : part.incomparables) all.push_back(data[i]);
+        return RankSampler(all, p.dims).best(p, {w}, boundTieEps).below;
+    };
+
     while (true) {
-        std::cout << "Cycle number " << n_exp << std::endl;
-        int minorder = std::numeric_limits<int>::max();
+        TRACE_SCOPE("expansionCycle", n_exp);
+        queryMetrics.expansionCycles++;
+        if (!quietMode) std::cout << "Cycle number " << n_exp << '\n';
+        int minorder = maxOrder;
         std::vector<Cell> mincells;
+        // Lean search: non-singular cells are not kept, only their halfspaces to expand
+        std::vector<long> leanExpand;
+        size_t mincellCount = 0;
+
+        ExplainCycle explain;
+        explain.cycle = n_exp;
+        size_t leavesReached = 0;
 
         auto start = std::chrono::high_resolution_clock::now();
+        ScopedPhase leafSearchPhase(Phase::LEAF_SEARCH);
         for (auto leaf : leaves) {
             int leaf_order = static_cast<int>(leaf->order);
             if (leaf_order > minorder || leaf_order > minorder_singular) {
                 break;
             }
-            //prune away leaf nodes that lie about hyperplane q_1+q2+...+q_d < 1;
-            if (!MbrIsValid(leaf->mbr, Comb, dims, queryPlane)) {
-                continue;
-            }
+            leavesReached++;
+            checkQueryDeadline();
+            queryMetrics.leavesVisited++;
+            // A leaf across q_1+...+q_d = 1 holds the halfspaces of its part inside the simplex,
+            // and the q_1+...+q_d <= 1 row of the LP keeps its cells there
 
+            if (leaf->halfspaces.size() > static_cast<size_t>(halfspacesLengthLimit)) queryMetrics.limitsHit++;
             int hamweight = 0;
-            while (hamweight <= leaf->halfspaces.size() && leaf_order + hamweight <= minorder && leaf_order + hamweight <= minorder_singular && hamweight <= limitHamWeight) {
+            int lastHamweight = -1;  // last weight actually tried in this leaf (explain mode)
+            while (static_cast<size_t>(hamweight) <= leaf->halfspaces.size() && leaf_order + hamweight <= minorder && leaf_order + hamweight <= minorder_singular && hamweight <= limitHamWeight) {
+                lastHamweight = hamweight;
                 //std::cout << "Hamweight " << hamweight << ", numero hs: " << leaf->halfspaces.size();
-                std::vector<std::string> hamstrings = genhammingstrings(static_cast<int>(leaf->halfspaces.size()), hamweight);
+                std::vector<Cell> cells;
+                size_t generated;
+                if (leanSearch) {
+                    cells = searchmincells_lp_chunked(*leaf, hamweight, generated);
+                } else {
+                    std::vector<std::string> hamstrings = genhammingstrings(static_cast<int>(leaf->halfspaces.size()), hamweight);
+                    generated = hamstrings.size();
+                    cells = searchmincells_lp(*leaf, hamstrings);
+                }
+                queryMetrics.hamstringsGenerated += static_cast<long>(generated);
                 //std::cout << ", Hamstring " << hamstrings.size();
-                std::vector<Cell> cells = searchmincells_lp(*leaf, hamstrings);
                 //std::cout << ", Celle " << cells.size() << std::endl;
                 if (!cells.empty()) {
                     for (auto& cell : cells) {
                         cell.order = leaf_order + hamweight;
                     }
+                    // Decision mode: an exact (singular) cell within the threshold settles it
+                    if (rankThreshold > 0) {
+                        const auto singular = std::find_if(cells.begin(), cells.end(), [](const Cell& c) { return c.issingular(); });
+                        if (singular != cells.end()) {
+                            // With truncated leaves the rank at the witness counts, if it stays within the threshold
+                            const int order = truncatedOrders() ? witnessOrder(*singular) : singular->order;
+                            if (order <= maxOrder) {
+                                return {dominatorCount + order + 1, {*singular}};
+                            }
+                        }
+                    }
 
                     if (minorder > leaf_order + hamweight) {
                         minorder = leaf_order + hamweight;
-                        mincells = std::move(cells);
-                    } else {
-                        mincells.insert(mincells.end(), cells.begin(), cells.end());
+                        mincells.clear();
+                        leanExpand.clear();
+                        mincellCount = 0;
+                    }
+                    mincellCount += cells.size();
+                    for (auto& cell : cells) {
+                        if (!leanSearch || cell.issingular()) {
+                            mincells.push_back(std::move(cell));
+                            continue;
+                        }
+                        for (const auto k : cell.coveringHalfspaces()) {
+                            if (std::find(leanExpand.begin(), leanExpand.end(), k) == leanExpand.end()) leanExpand.push_back(k);
+                        }
                     }
                     break;
                 }
-                if (hamstrings.size() > maxNoBinStringToCheck) break;
+                if (generated > static_cast<size_t>(maxNoBinStringToCheck)) {
+                    queryMetrics.limitsHit++;
+                    break;
+                }
                 hamweight++;
             }
+            // Stopped by limitHamWeight while heavier strings were still worth checking
+            if (hamweight > limitHamWeight && static_cast<size_t>(hamweight) <= leaf->halfspaces.size() &&
+                leaf_order + hamweight <= minorder && leaf_order + hamweight <= minorder_singular) {
+                queryMetrics.limitsHit++;
+            }
+            explain.leavesSearched++;
+            if (explainMode) explain.hamweightReached[lastHamweight]++;
         }
+        leafSearchPhase.stop();
         auto end = std::chrono::high_resolution_clock::now();
         std::chrono::duration<double> elapsed = end - start;
-        std::cout << "> Expansion " << n_exp << ": Found " << mincells.size() << " mincell(s) in " << elapsed.count() << " seconds.\n" << std::endl;
+        if (!quietMode) std::cout << "> Expansion " << n_exp << ": Found " << mincellCount << " mincell(s) in " << elapsed.count() << " seconds.\n" << '\n';
 
         int new_singulars = 0;
         std::vector<std::shared_ptr<HalfSpace>> to_expand;
+        for (const auto k : leanExpand) {
+            const auto hs = halfspaceCache->get(k);
+            if (hs->arr == Arrangement::AUGMENTED && std::find(to_expand.begin(), to_expand.end(), hs) == to_expand.end()) {
+                to_expand.push_back(hs);
+            }
+        }
         for (auto& cell : mincells) {
             if (cell.issingular()) {
                 minorder_singular = cell.order;
                 mincells_singular.push_back(cell);
                 new_singulars++;
             } else {
-                for (const auto k : cell.covered) {
+                for (const auto k : cell.coveringHalfspaces()) {
                     const auto hs = halfspaceCache->get(k);
                     if (hs->arr == Arrangement::AUGMENTED && std::find(to_expand.begin(), to_expand.end(), hs) == to_expand.end()) {
                         to_expand.push_back(hs);
@@ -149,16 +359,71 @@ std::pair<int, std::vector<Cell>> aa_hd(const std::vector<Point>& data, const Po
                 }
             }
         }
-        if (new_singulars > 0) {
-            std::cout << "> Expansion " << n_exp << ": Found " << new_singulars << " singular mincell(s) with a minorder of " << minorder_singular << std::endl;
+
+        // Memory held by the query at the end of the cycle (tree, caches, cells, skyline buffers)
+        MemoryStats mem;
+        accountQTree(qt, mem);
+        mem.halfspaceBytes = halfspaceStorageBytes();
+        mem.cellBytes = cellsBytes(mincells) + cellsBytes(mincells_singular);
+        mem.skylineBytes = pointsBytes(sky) + pointsBytes(incomp);
+        mem.rssBytes = getCurrentMemory();
+        queryMetrics.recordMemory(mem);
+        governMemory(leaves, mem.trackedBytes());
+        if (!quietMode) {
+            std::cout << "> Expansion " << n_exp << ": " << mem.qtreeNodes << " QTree node(s), tracked memory "
+                      << static_cast<double>(mem.trackedBytes()) / (1024.0 * 1024.0) << " MB (QTree "
+                      << static_cast<double>(mem.qtreeBytes) / (1024.0 * 1024.0) << " MB)" << '\n';
+        }
+
+        if (new_singulars > 0 && !quietMode) {
+            std::cout << "> Expansion " << n_exp << ": Found " << new_singulars << " singular mincell(s) with a minorder of " << minorder_singular << '\n';
+        }
+
+        if (explainMode) {
+            explainQTree(qt, explain);
+            explain.leaves = leaves.size();
+            explain.leavesPruned = insertPruned;
+            explain.leavesCutOff = leaves.size() - leavesReached;
+            explain.mincells = mincellCount;
+            explain.halfspacesToExpand = to_expand.size();
+            queryExplain.push_back(std::move(explain));
+        }
+
+        // Decision mode: no cell within the threshold, and expanding only raises orders. A search
+        // cut short by the limits proves nothing: the full search answers instead
+        if (rankThreshold > 0 && mincellCount == 0 && leanExpand.empty()) {
+            if (queryMetrics.limitsHit > 0) return aa_hd(data, p);
+            return {rankThreshold + 1, {}};
         }
 
         if (to_expand.empty()) {
-            return {static_cast<int>(dominators.size()) + minorder_singular + 1, mincells_singular};
+            // No cell within the sampled bound: its weights are the best known
+            if (mincells_singular.empty() && !sampledCells.empty()) {
+                return {queryMetrics.sampledBound, sampledCells};
+            }
+            if (truncatedOrders() && !mincells_singular.empty()) {
+                const Cell& witness = mincells_singular.front();
+                const int below = witnessOrder(witness);
+                if (!sampledCells.empty() && sampledOrder < below) {
+                    return {queryMetrics.sampledBound, sampledCells};
+                }
+                return {dominatorCount + below + 1, {witness}};
+            }
+            // Every weight lies in a leaf, so only a search cut short by the limits finds no cell:
+            // the rank at the centre of the simplex is then the bound
+            if (mincells_singular.empty()) {
+                if (queryMetrics.limitsHit == 0) {
+                    throw std::logic_error("aa_hd found no cell for query " + std::to_string(p.id));
+                }
+                const Cell centre(0, std::string(), std::vector<long>(), std::vector<long>(),
+                                  std::vector<std::array<float, 2>>(), Point(std::vector<double>(dims, 1.0 / (dims + 1))));
+                return {dominatorCount + witnessOrder(centre) + 1, {centre}};
+            }
+            return {dominatorCount + minorder_singular + 1, mincells_singular};
         }
 
         n_exp++;
-        std::cout << "> Expansion " << n_exp << ": " << to_expand.size() << " halfspace(s) will be expanded" << std::endl;
+        if (!quietMode) std::cout << "> Expansion " << n_exp << ": " << to_expand.size() << " halfspace(s) will be expanded" << '\n';
 
         for (auto &hs : to_expand) {
             hs->arr = Arrangement::SINGULAR;
@@ -182,14 +447,17 @@ std::pair<int, std::vector<Cell>> aa_hd(const std::vector<Point>& data, const Po
         incomp = std::move(new_incomp);
 
         std::tie(sky, leaves) = updateqt(sky);
+        governMemory(leaves, 0);
     }
 }
 
 
 std::pair<int, std::vector<Interval>> aa_2d(const std::vector<Point>& data, const Point& p) {
     // 1) Troviamo dominatori e incomparabili
-    std::vector<Point> dominators = getdominators(data, p);
-    std::vector<Point> incomp     = getincomparables(data, p);
+    const DominancePartition part = partitionRecords(data, p);
+    std::vector<Point> incomp;
+    incomp.reserve(part.incomparables.size());
+    for (const size_t i : part.incomparables) incomp.push_back(data[i]);
 
     // 2) Skyline dei soli incomparabili
     std::vector<Point> sky = getskyline(incomp);
@@ -237,7 +505,7 @@ std::pair<int, std::vector<Interval>> aa_2d(const std::vector<Point>& data, cons
         false
     );
 
-    std::cout << "> " << sky.size() << " halfline(s) have been inserted" << std::endl;
+    if (!quietMode) std::cout << "> " << sky.size() << " halfline(s) have been inserted" << '\n';
 
     // 6) Avviamo il ciclo di espansione
     int n_exp = 0;
@@ -286,12 +554,13 @@ std::pair<int, std::vector<Interval>> aa_2d(const std::vector<Point>& data, cons
             // Aggiorniamo last_end
             last_end = cell.range.second;
 
-            // Aggiorniamo minorder e mincells
-            if (cell.order < minorder) {
+            // Aggiorniamo minorder e mincells; the range between two tied intersections is empty
+            const bool reachable = cell.range.second - cell.range.first > halflineTieEps;
+            if (reachable && cell.order < minorder) {
                 minorder = cell.order;
                 mincells.clear();
                 mincells.push_back(cell);
-            } else if (cell.order == minorder) {
+            } else if (reachable && cell.order == minorder) {
                 mincells.push_back(cell);
             }
 
@@ -308,7 +577,7 @@ std::pair<int, std::vector<Interval>> aa_2d(const std::vector<Point>& data, cons
             }
         }
 
-        std::cout << "> Expansion " << n_exp << ": Found " << mincells.size() << " mincell(s)" << std::endl;
+        if (!quietMode) std::cout << "> Expansion " << n_exp << ": Found " << mincells.size() << " mincell(s)" << '\n';
 
         // 6c) Controlliamo mincells per eventuali singolari
         //     e costruiamo la lista di halflines da "espandere"
@@ -334,25 +603,25 @@ std::pair<int, std::vector<Interval>> aa_2d(const std::vector<Point>& data, cons
             }
         }
 
-        if (new_singulars > 0) {
+        if (new_singulars > 0 && !quietMode) {
             std::cout << "> Expansion " << n_exp << ": Found "
                       << new_singulars << " singular mincell(s) with a minorder of "
-                      << minorder << std::endl;
+                      << minorder << '\n';
         }
 
         // 6d) Se non ci sono halflines da espandere, abbiamo finito:
         if (to_expand.empty()) {
-            // Il MaxRank in 2D è dominators.size() + minorder + 1
+            // Il MaxRank in 2D è dominators + minorder + 1
             return std::make_pair(
-                (int)dominators.size() + minorder + 1,
+                (int)part.dominators + minorder + 1,
                 mincells_singular
             );
         }
 
         // Altrimenti si continua l'espansione
         n_exp++;
-        std::cout << "> Expansion " << n_exp << ": "
-                  << to_expand.size() << " halfline(s) will be expanded" << std::endl;
+        if (!quietMode) std::cout << "> Expansion " << n_exp << ": "
+                                  << to_expand.size() << " halfline(s) will be expanded" << '\n';
 
         // 6e) Segniamo come SINGULAR le halflines in to_expand
         //     e rimuoviamo i corrispondenti punti “incomparabili”:
@@ -396,9 +665,9 @@ std::pair<int, std::vector<Interval>> aa_2d(const std::vector<Point>& data, cons
             );
         }
 
-        if (!to_insert.empty()) {
+        if (!to_insert.empty() && !quietMode) {
             std::cout << "> " << to_insert.size()
-                      << " halfline(s) have been inserted" << std::endl;
+                      << " halfline(s) have been inserted" << '\n';
         }
     } // while (true)
 }
\ No newline at end of file
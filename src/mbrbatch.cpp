@@ -0,0 +1,215 @@
+#include "mbrbatch.h"
+#include <algorithm>
+#include <atomic>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define MBRBATCH_AVX512 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// classify() builds positions from these values
+static_assert(static_cast<int>(PositionHS::BELOW) == 0 && static_cast<int>(PositionHS::ABOVE) == 1 &&
+              static_cast<int>(PositionHS::OVERLAPPED) == 2, "PositionHS values used by MbrBatch::classify");
+
+// Largest magnitude taken by the float path: leaves room for the sums before overflowing
+constexpr double floatPathMax = 1e30;
+
+/**
+ * True if v converts to float with a relative error of at most FLT_EPSILON / 2
+ * (zero, or a normal float far from overflow).
+ */
+bool fitsFloat(const double v) {
+    const double a = std::fabs(v);
+    return a == 0.0 || (a >= FLT_MIN && a <= floatPathMax);
+}
+
+/**
+ * Codes of one block of MbrBatch::lanes boxes: 0 / 1 / 2 for BELOW / ABOVE / OVERLAPPED, 3 if
+ * the float sums are too close to the hyperplane to call. low and high point at the block in
+ * dimension 0, the next dimension starts padded floats further.
+ */
+using BlockCodes = void (*)(const float* low, const float* high, size_t padded, size_t dims,
+                            const double* coeff, float kLow, float kHigh, int* codes);
+
+void blockCodesPortable(const float* low, const float* high, const size_t padded, const size_t dims,
+                        const double* coeff, const float kLow, const float kHigh, int* codes) {
+    constexpr size_t lanes = MbrBatch::lanes;
+    alignas(64) float minVal[lanes] = {}, maxVal[lanes] = {};
+    for (size_t d = 0; d < dims; ++d) {
+        const float c = static_cast<float>(coeff[d]);
+        // The bound reached first by c * x: low for c >= 0, high otherwise
+        const float* first = (c >= 0 ? low : high) + d * padded;
+        const float* second = (c >= 0 ? high : low) + d * padded;
+        for (size_t l = 0; l < lanes; ++l) {
+            minVal[l] += c * first[l];
+            maxVal[l] += c * second[l];
+        }
+    }
+    // The three tests exclude each other and are combined without branches, which the boxes
+    // of a batch would mispredict. NaN / inf (overflow) fail every test: code 3
+    for (size_t l = 0; l < lanes; ++l) {
+        const int below = maxVal[l] < kLow;
+        const int above = minVal[l] > kHigh;
+        const int overlapped = (maxVal[l] >= kHigh) & (minVal[l] <= kLow);
+        codes[l] = 3 - 3 * below - 2 * above - overlapped;
+    }
+}
+
+#ifdef MBRBATCH_AVX512
+static_assert(MbrBatch::lanes == 16, "one AVX-512 register of floats per block");
+
+// The same products, sums and ordered comparisons as blockCodesPortable, one register per block
+__attribute__((target("avx512f")))
+void blockCodesAvx512(const float* low, const float* high, const size_t padded, const size_t dims,
+                      const double* coeff, const float kLow, const float kHigh, int* codes) {
+    __m512 minVal = _mm512_setzero_ps();
+    __m512 maxVal = _mm512_setzero_ps();
+    for (size_t d = 0; d < dims; ++d) {
+        const float c = static_cast<float>(coeff[d]);
+        const __m512 cv = _mm512_set1_ps(c);
+        const __m512 first = _mm512_loadu_ps((c >= 0 ? low : high) + d * padded);
+        const __m512 second = _mm512_loadu_ps((c >= 0 ? high : low) + d * padded);
+        minVal = _mm512_add_ps(minVal, _mm512_mul_ps(cv, first));
+        maxVal = _mm512_add_ps(maxVal, _mm512_mul_ps(cv, second));
+    }
+    const __m512 lowBound = _mm512_set1_ps(kLow);
+    const __m512 highBound = _mm512_set1_ps(kHigh);
+    const __mmask16 below = _mm512_cmp_ps_mask(maxVal, lowBound, _CMP_LT_OQ);
+    const __mmask16 above = _mm512_cmp_ps_mask(minVal, highBound, _CMP_GT_OQ);
+    const __mmask16 overlapped = _mm512_cmp_ps_mask(maxVal, highBound, _CMP_GE_OQ) &
+                                 _mm512_cmp_ps_mask(minVal, lowBound, _CMP_LE_OQ);
+    __m512i code = _mm512_set1_epi32(3);
+    code = _mm512_mask_mov_epi32(code, below, _mm512_setzero_si512());
+    code = _mm512_mask_mov_epi32(code, above, _mm512_set1_epi32(1));
+    code = _mm512_mask_mov_epi32(code, overlapped, _mm512_set1_epi32(2));
+    _mm512_storeu_si512(codes, code);
+}
+
+bool cpuHasAvx512() {
+    return __builtin_cpu_supports("avx512f");
+}
+#else
+bool cpuHasAvx512() {
+    return false;
+}
+#endif
+
+std::atomic<bool> avx512Path{cpuHasAvx512()};
+
+} // namespace
+
+bool MbrBatch::avx512() {
+    return avx512Path.load(std::memory_order_relaxed);
+}
+
+void MbrBatch::setAvx512(const bool enabled) {
+    avx512Path.store(enabled && cpuHasAvx512(), std::memory_order_relaxed);
+}
+
+MbrBatch::MbrBatch(const std::vector<std::vector<std::array<float, 2>>>& boxes)
+    : count(boxes.size()),
+      padded((boxes.size() + lanes - 1) / lanes * lanes),
+      dims(boxes.empty() ? 0 : boxes.front().size()),
+      low(dims * padded, 0.0f),
+      high(dims * padded, 0.0f),
+      reach(dims, 0.0f)
+{
+    for (size_t b = 0; b < count; ++b) {
+        for (size_t d = 0; d < dims; ++d) {
+            const auto& range = boxes[b][d];
+            low[d * padded + b] = range[0];
+            high[d * padded + b] = range[1];
+            reach[d] = std::max(reach[d], std::max(std::fabs(range[0]), std::fabs(range[1])));
+        }
+    }
+}
+
+size_t MbrBatch::classify(const std::vector<double>& coeff, const double known, PositionHS* out) const {
+    auto exactAt = [&](const size_t b) {
+        return exactMbrPosition(coeff, known,
+                                [&](const size_t d) { return low[d * padded + b]; },
+                                [&](const size_t d) { return high[d * padded + b]; });
+    };
+
+    bool floatPath = fitsFloat(known) && coeff.size() == dims;
+    for (const double c : coeff) floatPath = floatPath && fitsFloat(c);
+    if (!floatPath) {
+        for (size_t b = 0; b < count; ++b) out[b] = exactAt(b);
+        return count;
+    }
+
+    // |float sum - double sum| <= (dims + 2) * FLT_EPSILON / 2 * (sum_d |c_d| * reach_d + |known|)
+    // for every box (coefficient and known conversions, products, additions); the margin doubles
+    // it, which also covers the rounding of kLow / kHigh, and FLT_MIN covers the absolute error
+    // of products falling in the subnormal range. One margin per call keeps the lane loop to
+    // the two sums.
+    const float kf = static_cast<float>(known);
+    float bound = std::fabs(kf);
+    for (size_t d = 0; d < dims; ++d) bound += std::fabs(static_cast<float>(coeff[d])) * reach[d];
+    const float margin = static_cast<float>(dims + 2) * FLT_EPSILON * bound + FLT_MIN;
+    const float kLow = kf - margin;
+    const float kHigh = kf + margin;
+
+    const BlockCodes blockCodes =
+#ifdef MBRBATCH_AVX512
+        avx512() ? blockCodesAvx512 :
+#endif
+        blockCodesPortable;
+
+    size_t exact = 0;
+    alignas(64) int codes[lanes];
+    for (size_t base = 0; base < count; base += lanes) {
+        blockCodes(low.data() + base, high.data() + base, padded, dims, coeff.data(), kLow, kHigh, codes);
+        // 3 (no test passed): too close to call, or NaN / inf, recomputed exactly
+        const size_t live = std::min(lanes, count - base);
+        for (size_t l = 0; l < live; ++l) {
+            const int code = codes[l];
+            if (code == 3) {
+                out[base + l] = exactAt(base + l);
+                exact++;
+            } else {
+                out[base + l] = static_cast<PositionHS>(code);
+            }
+        }
+    }
+    return exact;
+}
+
+size_t MbrBatch::bytes() const {
+    return (low.capacity() + high.capacity() + reach.capacity()) * sizeof(float);
+}
+
+PositionHS simplexPartPosition(const std::vector<double>& coeff, const double known,
+                               const std::vector<std::array<float, 2>>& mbr) {
+    double base = 0.0, budget = 1.0, highSum = 0.0;
+    for (size_t d = 0; d < coeff.size(); ++d) {
+        base += coeff[d] * mbr[d][0];
+        budget -= mbr[d][0];
+        highSum += mbr[d][1];
+    }
+    if (highSum <= 1.0 || budget < 0.0) return PositionHS::OVERLAPPED;
+
+    // Fractional knapsack with unit weights: greedy by coefficient is optimal
+    std::vector<size_t> byCoeff(coeff.size());
+    std::iota(byCoeff.begin(), byCoeff.end(), 0);
+    std::sort(byCoeff.begin(), byCoeff.end(), [&](const size_t a, const size_t b) { return coeff[a] > coeff[b]; });
+    auto extreme = [&](auto first, auto last, const double sign) {
+        double val = base, left = budget;
+        for (auto it = first; it != last && left > 0.0 && sign * coeff[*it] > 0.0; ++it) {
+            const double step = std::min(static_cast<double>(mbr[*it][1]) - mbr[*it][0], left);
+            val += coeff[*it] * step;
+            left -= step;
+        }
+        return val;
+    };
+    const double maxVal = extreme(byCoeff.begin(), byCoeff.end(), 1.0);
+    const double minVal = extreme(byCoeff.rbegin(), byCoeff.rend(), -1.0);
+    if (maxVal < known) return PositionHS::BELOW;
+    if (minVal > known) return PositionHS::ABOVE;
+    return PositionHS::OVERLAPPED;
+}
@@ -0,0 +1,23 @@
+#include "membudget.h"
+#include "config.h"
+#include "utils.h"
+#include <algorithm>
+
+MemoryBudget queryBudget;
+
+void MemoryBudget::start() {
+    limit = 0;
+    if (memoryBudget <= 0) return;
+
+    limit = static_cast<size_t>(memoryBudget) * 1024 * 1024;
+    // The system may not be able to give the whole budget
+    if (const size_t available = getAvailableMemory(); available > 0) {
+        limit = std::min(limit, getCurrentMemory() + available);
+    }
+}
+
+bool MemoryBudget::near(const size_t trackedBytes) const {
+    if (limit == 0) return false;
+    const size_t used = std::max(getCurrentMemory(), trackedBytes);
+    return static_cast<double>(used) >= highWater * static_cast<double>(limit);
+}
@@ -0,0 +1,94 @@
+#include "memstats.h"
+#include "cell.h"
+#include "halfspace.h"
+#include "qtree.h"
+#include <algorithm>
+
+void MemoryStats::maxWith(const MemoryStats& other) {
+    qtreeNodes = std::max(qtreeNodes, other.qtreeNodes);
+    if (nodesPerLevel.size() < other.nodesPerLevel.size()) {
+        nodesPerLevel.resize(other.nodesPerLevel.size(), 0);
+    }
+    for (size_t l = 0; l < other.nodesPerLevel.size(); l++) {
+        nodesPerLevel[l] = std::max(nodesPerLevel[l], other.nodesPerLevel[l]);
+    }
+    qtreeBytes = std::max(qtreeBytes, other.qtreeBytes);
+    halfspaceBytes = std::max(halfspaceBytes, other.halfspaceBytes);
+    cellBytes = std::max(cellBytes, other.cellBytes);
+    skylineBytes = std::max(skylineBytes, other.skylineBytes);
+    rssBytes = std::max(rssBytes, other.rssBytes);
+}
+
+namespace {
+
+size_t nodeBytes(const QNode& node) {
+    return sizeof(QNode)
+           + node.children.capacity() * sizeof(QNode*)
+           + (node.covered.capacity() + node.halfspaces.capacity()) * sizeof(long)
+           + node.mbr.capacity() * sizeof(std::array<float, 2>)
+           + node.childBoxes.bytes();
+}
+
+void accountSubtree(const QNode* subRoot, MemoryStats& out) {
+    // Iterative DFS: trees can be deep enough to make recursion a concern
+    std::vector<const QNode*> stack = {subRoot};
+    while (!stack.empty()) {
+        const QNode* node = stack.back();
+        stack.pop_back();
+
+        out.qtreeNodes++;
+        out.qtreeBytes += nodeBytes(*node);
+        const auto level = static_cast<size_t>(std::max(node->level, 0));
+        if (out.nodesPerLevel.size() <= level) out.nodesPerLevel.resize(level + 1, 0);
+        out.nodesPerLevel[level]++;
+
+        for (const QNode* child : node->children) {
+            if (child) stack.push_back(child);
+        }
+    }
+}
+
+} // namespace
+
+void accountQTree(const QTree& qt, MemoryStats& out) {
+    out.qtreeNodes = 0;
+    out.qtreeBytes = sizeof(QTree)
+                     + qt.macroRoots.capacity() * sizeof(QNode*)
+                     + qt.precomputedSubMBRs.size() * qt.dims * sizeof(std::array<float, 2>)
+                     + qt.simplexSubMBRs.capacity() * sizeof(int)
+                     + qt.subMBRBoxes.bytes();
+    out.nodesPerLevel.clear();
+
+    if (qt.root) accountSubtree(qt.root, out);
+    for (const QNode* sr : qt.macroRoots) {
+        if (sr) accountSubtree(sr, out);
+    }
+}
+
+size_t halfspaceStorageBytes() {
+    size_t bytes = halfspaceCache ? halfspaceCache->memoryBytes() : 0;
+    bytes += pointToHalfSpaceCache.bucket_count() * sizeof(void*);
+    for (const auto& [pnt, id] : pointToHalfSpaceCache) {
+        bytes += sizeof(void*) + sizeof(std::pair<const Point, long>) + pnt.coord.capacity() * sizeof(double);
+    }
+    return bytes;
+}
+
+size_t pointsBytes(const std::vector<Point>& points) {
+    size_t bytes = points.capacity() * sizeof(Point);
+    for (const auto& pt : points) {
+        bytes += pt.coord.capacity() * sizeof(double);
+    }
+    return bytes;
+}
+
+size_t cellsBytes(const std::vector<Cell>& cells) {
+    size_t bytes = cells.capacity() * sizeof(Cell);
+    for (const auto& cell : cells) {
+        bytes += cell.mask.capacity()
+                 + (cell.covered.capacity() + cell.halfspaces.capacity()) * sizeof(long)
+                 + cell.leaf_mbr.capacity() * sizeof(std::array<float, 2>)
+                 + cell.feasible_pnt.coord.capacity() * sizeof(double);
+    }
+    return bytes;
+}
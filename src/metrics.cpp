@@ -0,0 +1,98 @@
+#include "metrics.h"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+QueryMetrics queryMetrics;
+
+ScopedPhase::ScopedPhase(const Phase phase)
+    : target(queryMetrics.phases[static_cast<int>(phase)]),
+      running(true),
+      startHw(readPerfCounters()),
+      start(std::chrono::high_resolution_clock::now()) {}
+
+void ScopedPhase::stop() {
+    if (!running) return;
+    running = false;
+    const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+    target.time += elapsed.count();
+    if (perfCountersAvailable()) {
+        const HwCounterValues endHw = readPerfCounters();
+        for (int i = 0; i < numHwCounters; i++) {
+            if (startHw[i] == hwCounterUnread || endHw[i] == hwCounterUnread) continue;
+            // Multiplexing scales each reading separately, so a short phase can read backwards
+            if (endHw[i] > startHw[i]) target.hw[i] += endHw[i] - startHw[i];
+        }
+    }
+}
+
+void writeMetricsCSV(const std::string& filename, const std::vector<MetricsRecord>& records, const bool append) {
+    const bool continuing = append && std::filesystem::exists(filename);
+    std::ofstream file(filename, continuing ? std::ios::app : std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    // On resume the header is already there
+    if (!continuing) {
+        file << "id,maxrank,expansion_cycles,lps_solved,lps_feasible,leaves_visited,leaves_pruned,"
+                "hamstrings,halfspaces_inserted,limits_hit,sampled_bound,skyband_pruned,skyline_s,insert_s,lp_s,total_s,"
+                "qtree_nodes,qtree_bytes,halfspace_bytes,cell_bytes,skyline_bytes,tracked_bytes,"
+                "peak_qtree_bytes,peak_halfspace_bytes,peak_cell_bytes,peak_skyline_bytes,peak_tracked_bytes,peak_rss_bytes,budget_hit";
+        // Per-phase columns; hardware counters are left empty when they are not available
+        for (const char* phase : phaseNames) {
+            file << "," << phase << "_wall_s," << phase << "_cycles," << phase << "_instructions,"
+                 << phase << "_llc_misses," << phase << "_branch_misses";
+        }
+        file << "\n";
+    }
+    for (const auto& rec : records) {
+        const QueryMetrics& m = rec.metrics;
+        file << rec.id << "," << rec.maxrank << ","
+             << m.expansionCycles << "," << m.lpsSolved << "," << m.lpsFeasible << ","
+             << m.leavesVisited << "," << m.leavesPruned << "," << m.hamstringsGenerated << ","
+             << m.halfspacesInserted << "," << m.limitsHit << "," << m.sampledBound << "," << m.skybandPruned << ","
+             << m.skylineTime << "," << m.insertTime << "," << m.lpTime << "," << m.totalTime;
+        // Current = last cycle of the query, peak = maximum over its cycles
+        const MemoryStats current = m.cycleMemory.empty() ? MemoryStats() : m.cycleMemory.back();
+        file << "," << current.qtreeNodes << "," << current.qtreeBytes << "," << current.halfspaceBytes << ","
+             << current.cellBytes << "," << current.skylineBytes << "," << current.trackedBytes() << ","
+             << m.peakMemory.qtreeBytes << "," << m.peakMemory.halfspaceBytes << "," << m.peakMemory.cellBytes << ","
+             << m.peakMemory.skylineBytes << "," << m.peakTrackedBytes << "," << m.peakRssBytes << ","
+             << (m.memoryBudgetHit ? 1 : 0);
+        for (const auto& phase : m.phases) {
+            file << "," << phase.time;
+            for (const uint64_t v : phase.hw) {
+                file << ",";
+                if (perfCountersAvailable()) file << v;
+            }
+        }
+        file << "\n";
+    }
+}
+
+void writeMemoryCSV(const std::string& filename, const std::vector<MetricsRecord>& records, const bool append) {
+    const bool continuing = append && std::filesystem::exists(filename);
+    std::ofstream file(filename, continuing ? std::ios::app : std::ios::trunc);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    if (!continuing) {
+        file << "id,cycle,qtree_nodes,nodes_per_level,qtree_bytes,halfspace_bytes,cell_bytes,skyline_bytes,"
+                "tracked_bytes,rss_bytes\n";
+    }
+    for (const auto& rec : records) {
+        const auto& cycles = rec.metrics.cycleMemory;
+        for (size_t c = 0; c < cycles.size(); c++) {
+            const MemoryStats& mem = cycles[c];
+            file << rec.id << "," << c << "," << mem.qtreeNodes << ",";
+            // Node count of each level, separated by ';' (level 0 first)
+            for (size_t l = 0; l < mem.nodesPerLevel.size(); l++) {
+                file << (l ? ";" : "") << mem.nodesPerLevel[l];
+            }
+            file << "," << mem.qtreeBytes << "," << mem.halfspaceBytes << "," << mem.cellBytes << ","
+                 << mem.skylineBytes << "," << mem.trackedBytes() << "," << mem.rssBytes << "\n";
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#include "perfcounters.h"
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace {
+
+bool available = false;
+bool attempted = false;
+
+#if defined(__linux__)
+std::array<int, numHwCounters> fds = {-1, -1, -1, -1};
+
+constexpr std::array<uint64_t, numHwCounters> eventConfigs = {
+    PERF_COUNT_HW_CPU_CYCLES,
+    PERF_COUNT_HW_INSTRUCTIONS,
+    PERF_COUNT_HW_CACHE_MISSES,     // last-level cache misses on most CPUs
+    PERF_COUNT_HW_BRANCH_MISSES
+};
+
+int openEvent(const uint64_t config) {
+    perf_event_attr attr;
+    std::memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = config;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    // Count the worker threads spawned by the parallel phases too. Group reads are not
+    // allowed on inherited events, so every event is opened (and read) on its own.
+    attr.inherit = 1;
+    attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    return static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+}
+#endif
+
+} // namespace
+
+bool openPerfCounters() {
+    if (attempted) return available;
+    attempted = true;
+
+#if defined(__linux__)
+    for (int i = 0; i < numHwCounters; i++) {
+        fds[i] = openEvent(eventConfigs[i]);
+        if (fds[i] < 0) {
+            // All or nothing: a partial set would make the per-phase rows inconsistent
+            for (int j = 0; j < i; j++) {
+                close(fds[j]);
+                fds[j] = -1;
+            }
+            return false;
+        }
+    }
+    available = true;
+#endif
+    return available;
+}
+
+bool perfCountersAvailable() {
+    return available;
+}
+
+HwCounterValues readPerfCounters() {
+    HwCounterValues values{};
+#if defined(__linux__)
+    if (!available) return values;
+    for (int i = 0; i < numHwCounters; i++) {
+        uint64_t buf[3] = {0, 0, 0};  // value, time enabled, time running
+        if (read(fds[i], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf))) {
+            values[i] = hwCounterUnread;
+            continue;
+        }
+        // Scale up if the PMU was shared with other events (multiplexing)
+        values[i] = (buf[2] > 0 && buf[2] < buf[1])
+                        ? static_cast<uint64_t>(static_cast<double>(buf[0]) * buf[1] / buf[2])
+                        : buf[0];
+    }
+#endif
+    return values;
+}
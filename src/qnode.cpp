@@ -1,7 +1,8 @@
 #include "qnode.h"
 #include "qtree.h"
-
-static int normalizedMax = 1;
+#include "config.h"
+#include "utils.h"
+#include <algorithm>
 
 QNode::QNode(QTree* owner,
              QNode* parent,
@@ -15,6 +16,7 @@ QNode::QNode(QTree* owner,
       leafIndex(-1),
       mbr(mbr),
       norm(true),
+      inside(MbrIsValid(mbr)),
       leaf(true),
       order(0),
       level(level)
@@ -43,32 +45,22 @@ PositionHS QNode::MbrVersusHalfSpace(const std::vector<double>& coeff, const dou
     if (mbr.empty()) {
         return PositionHS::OVERLAPPED;
     }
-    double minVal = 0.0, maxVal = 0.0;
-    size_t dcount = coeff.size();
-
-    for (size_t i = 0; i < dcount; ++i) {
-        double c = coeff[i];
-        // MBR coords in float
-        float low  = mbr[i][0];
-        float high = mbr[i][1];
-        if (c >= 0) {
-            minVal += c * low;
-            maxVal += c * high;
-        } else {
-            minVal += c * high;
-            maxVal += c * low;
-        }
-    }
-    if (maxVal < known)  return PositionHS::BELOW;
-    if (minVal > known)  return PositionHS::ABOVE;
-    return PositionHS::OVERLAPPED;
+    // MBR coords in float, sums in double
+    const PositionHS pos = exactMbrPosition(coeff, known,
+                                            [this](const size_t d) { return mbr[d][0]; },
+                                            [this](const size_t d) { return mbr[d][1]; });
+    // Across sum(w) = 1 only the part inside the simplex holds weights
+    return pos == PositionHS::OVERLAPPED && !inside ? simplexPartPosition(coeff, known, mbr) : pos;
 }
 
 void QNode::insertHalfspace(const long hsID) {
     const auto hs = halfspaceCache->get(hsID);
     if (!hs) return;
 
-    PositionHS pos = MbrVersusHalfSpace(hs->coeff, hs->known);
+    insertClassified(hsID, *hs, MbrVersusHalfSpace(hs->coeff, hs->known));
+}
+
+void QNode::insertClassified(const long hsID, const HalfSpace& hs, const PositionHS pos) {
     switch (pos) {
         case PositionHS::BELOW:
             // This halfspace is fully covering the node (delta coverage)
@@ -77,6 +69,10 @@ void QNode::insertHalfspace(const long hsID) {
         case PositionHS::OVERLAPPED:
             // Partially covers the node
             if (leaf) {
+                // Over the memory budget leaves no longer split and keep only what the leaf search reads
+                if (owner->splitsFrozen.load(std::memory_order_relaxed) && !keepsHalfspacesFrozen()) {
+                    break;
+                }
                 halfspaces.push_back(hsID);
                 // Check capacity -> split if we exceed maxhsnode
                 if ((int)halfspaces.size() > owner->maxhsnode && norm) {
@@ -85,8 +81,10 @@ void QNode::insertHalfspace(const long hsID) {
                         // Redistribute existing halfspaces to children
                         if (!children.empty()) {
                             for (auto h : halfspaces) {
-                                for (auto* ch : children) {
-                                    if (ch) ch->insertHalfspace(h);
+                                if (h == hsID) {
+                                    insertIntoChildren(h, hs);
+                                } else if (const auto other = halfspaceCache->get(h)) {
+                                    insertIntoChildren(h, *other);
                                 }
                             }
                             halfspaces.clear();
@@ -96,9 +94,7 @@ void QNode::insertHalfspace(const long hsID) {
                 }
             } else {
                 // Propagate to children
-                for (auto* ch : children) {
-                    if (ch) ch->insertHalfspace(hsID);
-                }
+                insertIntoChildren(hsID, hs);
             }
             break;
         case PositionHS::ABOVE:
@@ -107,6 +103,28 @@ void QNode::insertHalfspace(const long hsID) {
     }
 }
 
+bool QNode::keepsHalfspacesFrozen() const {
+    // The leaf search reads only the first halfspacesLengthLimit halfspaces (one more tells it that the leaf is truncated)
+    if (halfspaces.size() > static_cast<size_t>(halfspacesLengthLimit)) return false;
+    // Neither is a leaf above maxSearchedOrder: its order (covered halfspaces up the chain) only grows
+    size_t chainOrder = 0;
+    for (const QNode* node = this; node; node = node->parent) chainOrder += node->covered.size();
+    return chainOrder <= owner->maxSearchedOrder;
+}
+
+void QNode::insertIntoChildren(const long hsID, const HalfSpace& hs) {
+    // One batched classification for all children instead of one per child
+    std::vector<PositionHS> positions(childBoxes.size());
+    childBoxes.classify(hs.coeff, hs.known, positions.data());
+    size_t j = 0;
+    for (auto* ch : children) {
+        if (!ch) continue;
+        PositionHS pos = positions[j++];
+        if (pos == PositionHS::OVERLAPPED && !ch->inside) pos = simplexPartPosition(hs.coeff, hs.known, ch->mbr);
+        ch->insertClassified(hsID, hs, pos);
+    }
+}
+
 void QNode::insertHalfspaces(const std::vector<long>& new_halfspaces) {
     for (const auto id : new_halfspaces) {
         insertHalfspace(id);
@@ -114,8 +132,8 @@ void QNode::insertHalfspaces(const std::vector<long>& new_halfspaces) {
 }
 
 void QNode::splitNode() {
-    // Do not split if at max level or not valid
-    if (level == owner->maxLevel || !norm) {
+    // Do not split if at max level, not valid or over the memory budget
+    if (level == owner->maxLevel || !norm || owner->splitsFrozen.load(std::memory_order_relaxed)) {
         return;
     }
 
@@ -123,55 +141,90 @@ void QNode::splitNode() {
     size_t totalHS = halfspaces.size() + covered.size();
     if (totalHS < (size_t)owner->maxhsnode) return;
 
+    // Quad split: slot = mask of the upper parts; binary split: slot 0 / 1 = lower / upper part of splitDim
+    const bool quad = owner->split == QTreeSplit::QUAD;
+    const std::vector<float> cuts = owner->splitPositions(mbr, halfspaces);
+    int splitDim = -1;
+    if (!quad) {
+        splitDim = binarySplitDimension(cuts);
+        if (splitDim < 0) return; // every side is down to float resolution
+    }
+    const size_t numSlots = quad ? static_cast<size_t>(numOfSubdivisions) : 2;
+
     // Become an internal node
     setLeaf(false);
-    children.resize(numOfSubdivisions, nullptr);
+    children.resize(numSlots, nullptr);
 
     size_t dcount = mbr.size();
-    for (int mask = 0; mask < numOfSubdivisions; ++mask) {
-        std::vector<std::array<float,2>> child_mbr(dcount);
+    std::vector<std::vector<std::array<float,2>>> child_mbrs;
+    for (size_t slot = 0; slot < numSlots; ++slot) {
+        std::vector<std::array<float,2>> child_mbr(mbr);
         for (size_t d = 0; d < dcount; d++) {
+            if (!quad && static_cast<int>(d) != splitDim) continue;
             float minVal = mbr[d][0];
             float maxVal = mbr[d][1];
-            float mid = 0.5f * (minVal + maxVal);
-            if (mask & (1 << d)) {
-                child_mbr[d] = { mid, maxVal };
+            if (quad ? (slot & (size_t{1} << d)) : slot == 1) {
+                child_mbr[d] = { cuts[d], maxVal };
             } else {
-                child_mbr[d] = { minVal, mid };
+                child_mbr[d] = { minVal, cuts[d] };
             }
         }
-        // Create the child node
-        auto* child = new QNode(owner, this, child_mbr, level + 1);
-
-        // Validate the child node
-        if (child->checkNodeValidity()) {
-            child->norm = true;
-            children[mask] = child;
+        // Create the child node only if it is valid (some corner sum <= 1)
+        if (MbrIntersectsSimplex(child_mbr)) {
+            children[slot] = new QNode(owner, this, child_mbr, level + 1);
+            child_mbrs.push_back(std::move(child_mbr));
         } else {
-            child->norm = false;
-            delete child;
-            children[mask] = nullptr;
+            owner->nodesPruned.fetch_add(1, std::memory_order_relaxed);
         }
     }
+    childBoxes = MbrBatch(child_mbrs);
+    owner->noteSplit();
 }
 
-bool QNode::checkNodeValidity() const {
-    // For each corner in [min,max], check if sum of coordinates <= normalizedMax
-    size_t dcount = mbr.size();
-    size_t corners = (1 << dcount);
-
-    for (size_t i = 0; i < corners; ++i) {
-        double sum = 0.0;
-        for (size_t d = 0; d < dcount; d++) {
-            float coord = (i & (1 << d)) ? mbr[d][1] : mbr[d][0];
-            sum += coord;
+int QNode::binarySplitDimension(const std::vector<float>& cuts) const {
+    // Only sides that float can still cut
+    const size_t dcount = mbr.size();
+    std::vector<int> candidates;
+    for (size_t d = 0; d < dcount; ++d) {
+        if (mbr[d][0] < cuts[d] && cuts[d] < mbr[d][1]) candidates.push_back(static_cast<int>(d));
+    }
+    if (candidates.empty()) return -1;
+
+    // Widest side first, lowest dimension on ties
+    std::stable_sort(candidates.begin(), candidates.end(), [this](const int a, const int b) {
+        return mbr[a][1] - mbr[a][0] > mbr[b][1] - mbr[b][0];
+    });
+    if (owner->split == QTreeSplit::WIDEST || halfspaces.empty()) return candidates.front();
+
+    // Both parts of every candidate, classified against the node's halfspaces in one batch;
+    // parts outside the simplex get no child and hold nothing
+    std::vector<std::vector<std::array<float,2>>> halves;
+    std::vector<char> valid;
+    for (const int d : candidates) {
+        for (const auto& range : {std::array<float,2>{mbr[d][0], cuts[d]}, std::array<float,2>{cuts[d], mbr[d][1]}}) {
+            halves.push_back(mbr);
+            halves.back()[d] = range;
+            valid.push_back(MbrIntersectsSimplex(halves.back()) ? 1 : 0);
         }
-        // If at least one corner is inside normalized range, consider it valid
-        if (sum <= normalizedMax) {
-            return true;
+    }
+    const MbrBatch batch(halves);
+    std::vector<PositionHS> positions(halves.size());
+    std::vector<size_t> overlapping(candidates.size(), 0);
+    for (const long id : halfspaces) {
+        const auto hs = halfspaceCache->get(id);
+        if (!hs) continue;
+        batch.classify(hs->coeff, hs->known, positions.data());
+        for (size_t h = 0; h < halves.size(); ++h) {
+            if (valid[h] && positions[h] == PositionHS::OVERLAPPED) overlapping[h / 2]++;
         }
     }
-    return false;
+
+    // Fewest halfspaces left to the children; the widest side among equals
+    size_t best = 0;
+    for (size_t c = 1; c < candidates.size(); ++c) {
+        if (overlapping[c] < overlapping[best]) best = c;
+    }
+    return candidates[best];
 }
 
 void QNode::clearHalfspaces() {
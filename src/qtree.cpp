@@ -1,20 +1,56 @@
 #include "qtree.h"
-
-QTree::QTree(const int dims, const int maxhsnode, const int maxLevel)
+#include "config.h"
+#include "membudget.h"
+#include "trace.h"
+#include "utils.h"
+#include <iterator>
+#include <limits>
+
+QTree::QTree(const int dims, const int maxhsnode, const int maxLevel, const QTreeSplit split,
+             const SplitPosition position)
     : dims(dims),
       maxhsnode(maxhsnode),
-      maxLevel(maxLevel),
-      root(nullptr)
+      maxLevel(split == QTreeSplit::QUAD ? maxLevel : maxLevel * dims),
+      split(split),
+      position(position),
+      macroLevel(split == QTreeSplit::QUAD ? 1 : std::min(dims, macroBinaryDims)),
+      root(nullptr),
+      macroCutsFixed(position == SplitPosition::MIDPOINT),
+      maxSearchedOrder(std::numeric_limits<size_t>::max())
 {
     // Create the classical root covering [0,1]^dims
     root = createroot();
 
-    // Precompute sub-MBRs for macro-split (using float)
-    const std::vector<std::array<float,2>> globalMBR(dims, {0.0f, 1.0f});
-    precomputedSubMBRs = macroSplitMBR(globalMBR);
+    // Precompute sub-MBRs for macro-split (using float); balanced cuts wait for the first halfspaces
+    setMacroSplit(splitPositions(root->mbr, {}));
 
     // Prepare macroRoots, one for each sub-MBR
-    macroRoots.resize(numOfSubdivisions, nullptr);
+    macroRoots.resize(precomputedSubMBRs.size(), nullptr);
+    if (macroCutsFixed) createMacroRoots();
+}
+
+void QTree::createMacroRoots() {
+    // Every sub-MBR reaching the simplex gets one, even with no halfspace to hold: its
+    // weights are ranked by the halfspaces that cover it, or by none at all
+    for (const int i : simplexSubMBRs) {
+        if (!macroRoots[i]) macroRoots[i] = new QNode(this, nullptr, precomputedSubMBRs[i], macroLevel);
+    }
+    nodesPruned.fetch_add(precomputedSubMBRs.size() - simplexSubMBRs.size(), std::memory_order_relaxed);
+}
+
+void QTree::setMacroSplit(const std::vector<float>& cuts) {
+    const std::vector<std::array<float,2>> globalMBR(dims, {0.0f, 1.0f});
+    precomputedSubMBRs = macroSplitMBR(globalMBR, cuts);
+
+    // Sub-MBRs entirely above sum(w) = 1 hold no valid weight: they never get a macro-root
+    std::vector<std::vector<std::array<float,2>>> simplexBoxes;
+    simplexSubMBRs.clear();
+    for (int i = 0; i < (int) precomputedSubMBRs.size(); i++) {
+        if (!MbrIntersectsSimplex(precomputedSubMBRs[i])) continue;
+        simplexSubMBRs.push_back(i);
+        simplexBoxes.push_back(precomputedSubMBRs[i]);
+    }
+    subMBRBoxes = MbrBatch(simplexBoxes);
 }
 
 QTree::~QTree() {
@@ -60,39 +96,96 @@ void QTree::destroyAllNodes() {
     macroRoots.clear();
 }
 
+std::vector<float> QTree::splitPositions(const std::vector<std::array<float,2>>& mbr,
+                                         const std::vector<long>& halfspaces) const
+{
+    const size_t dcount = mbr.size();
+    std::vector<float> cuts(dcount);
+    for (size_t d = 0; d < dcount; ++d) {
+        cuts[d] = 0.5f * (mbr[d][0] + mbr[d][1]);
+    }
+    if (position == SplitPosition::MIDPOINT || halfspaces.empty()) return cuts;
+
+    // Lower and upper part of every side at every candidate cut, classified in one batch;
+    // parts outside the simplex get no child and hold nothing
+    const size_t numCandidates = std::size(balancedCutFractions);
+    std::vector<std::vector<std::array<float,2>>> parts;
+    std::vector<char> valid;
+    std::vector<float> candidateCuts;
+    parts.reserve(dcount * numCandidates * 2);
+    for (size_t d = 0; d < dcount; ++d) {
+        for (const float f : balancedCutFractions) {
+            const float cut = f == 0.5f ? cuts[d] : mbr[d][0] + f * (mbr[d][1] - mbr[d][0]);
+            candidateCuts.push_back(cut);
+            for (const auto& range : {std::array<float,2>{mbr[d][0], cut}, std::array<float,2>{cut, mbr[d][1]}}) {
+                parts.push_back(mbr);
+                parts.back()[d] = range;
+                valid.push_back(MbrIntersectsSimplex(parts.back()) ? 1 : 0);
+            }
+        }
+    }
+    const MbrBatch batch(parts);
+    std::vector<PositionHS> positions(parts.size());
+    std::vector<size_t> overlapping(parts.size(), 0);
+    for (const long id : halfspaces) {
+        const auto hs = halfspaceCache->get(id);
+        if (!hs) continue;
+        batch.classify(hs->coeff, hs->known, positions.data());
+        for (size_t k = 0; k < parts.size(); ++k) {
+            if (valid[k] && positions[k] == PositionHS::OVERLAPPED) overlapping[k]++;
+        }
+    }
+
+    // Per side: the cut whose fuller part overlaps the fewest halfspaces (first candidate on ties)
+    for (size_t d = 0; d < dcount; ++d) {
+        size_t bestLoad = std::numeric_limits<size_t>::max();
+        for (size_t c = 0; c < numCandidates; ++c) {
+            const size_t k = d * numCandidates + c;
+            const float cut = candidateCuts[k];
+            if (!(mbr[d][0] < cut && cut < mbr[d][1])) continue;
+            const size_t load = std::max(overlapping[2 * k], overlapping[2 * k + 1]);
+            if (load < bestLoad) {
+                bestLoad = load;
+                cuts[d] = cut;
+            }
+        }
+    }
+    return cuts;
+}
+
 std::vector< std::vector<std::array<float,2>> >
-QTree::macroSplitMBR(const std::vector<std::array<float,2>>& globalMBR) const
+QTree::macroSplitMBR(const std::vector<std::array<float,2>>& globalMBR, const std::vector<float>& cuts) const
 {
-    // Each bit in 'mask' picks lower or upper half for each dimension
-    std::vector< std::vector<std::array<float,2>> > result(1 << dims);
+    // Each bit in 'mask' picks lower or upper part for each of the first splitDims dimensions
+    const int splitDims = split == QTreeSplit::QUAD ? dims : macroLevel;
+    std::vector< std::vector<std::array<float,2>> > result(1 << splitDims);
 
-    for (int mask = 0; mask < (1 << dims); mask++) {
+    for (int mask = 0; mask < (1 << splitDims); mask++) {
         result[mask].resize(dims);
         for (int d = 0; d < dims; d++) {
             float minVal = globalMBR[d][0];
             float maxVal = globalMBR[d][1];
-            float mid    = 0.5f * (minVal + maxVal);
-            if (mask & (1 << d)) {
-                result[mask][d] = { mid, maxVal };
+            if (d >= splitDims) {
+                result[mask][d] = { minVal, maxVal };
+            } else if (mask & (1 << d)) {
+                result[mask][d] = { cuts[d], maxVal };
             } else {
-                result[mask][d] = { minVal, mid };
+                result[mask][d] = { minVal, cuts[d] };
             }
         }
     }
     return result;
 }
 
-QNode* QTree::buildSubtree(const std::vector<std::array<float,2>>& subMBR,
-                           const std::vector<long>& subHS) const
-{
-    // Create a new root node for this subMBR
-    auto* rootNode = new QNode(const_cast<QTree*>(this), nullptr, subMBR, 1);
-    // Insert halfspaces incrementally
-    rootNode->insertHalfspaces(subHS);
-    return rootNode;
-}
-
 void QTree::inserthalfspacesMacroSplit(const std::vector<long int>& halfspaces) {
+    TRACE_SCOPE("inserthalfspacesMacroSplit", static_cast<long long>(halfspaces.size()));
+
+    // Balanced cuts of the macro split come from the first batch, before any macro-root exists
+    if (!macroCutsFixed) {
+        setMacroSplit(splitPositions(root->mbr, halfspaces));
+        macroCutsFixed = true;
+        createMacroRoots();
+    }
     if (halfspaces.empty()) return;
 
     const int nSub = (int) precomputedSubMBRs.size();
@@ -101,7 +194,7 @@ void QTree::inserthalfspacesMacroSplit(const std::vector<long int>& halfspaces)
     std::vector<std::vector<long>> partialOverlapped(nSub);
 
     const size_t totalHS = halfspaces.size();
-    const unsigned int hwThreads = std::max(1U, std::thread::hardware_concurrency());
+    const unsigned int hwThreads = workerThreads();
     const size_t chunkSize = (totalHS + hwThreads - 1) / hwThreads;
 
     // partial results per thread
@@ -121,39 +214,29 @@ void QTree::inserthalfspacesMacroSplit(const std::vector<long int>& halfspaces)
         size_t end = std::min(start + chunkSize, totalHS);
 
         distributionFutures.push_back(std::async(std::launch::async,
-            [this, &halfspaces, start, end, &partialRes, t, nSub]()
+            [this, &halfspaces, start, end, &partialRes, t]()
         {
+            TRACE_SCOPE("distributeChunk", static_cast<long long>(end - start));
+            std::vector<PositionHS> positions(subMBRBoxes.size());
             for (size_t idx = start; idx < end; ++idx) {
                 long hsID = halfspaces[idx];
                 auto hsPtr = halfspaceCache->get(hsID);
                 if (!hsPtr) continue;
 
-                double known = hsPtr->known;           // We keep halfspace in double
-                const auto& cVec = hsPtr->coeff;       // also double
-
-                // For each subMBR
-                for (int i = 0; i < nSub; i++) {
-                    // We'll do minVal, maxVal in double for numeric stability
-                    double minVal = 0, maxVal = 0;
-                    for (size_t d = 0; d < cVec.size(); d++) {
-                        double c = cVec[d];
-                        float low = precomputedSubMBRs[i][d][0];
-                        float high= precomputedSubMBRs[i][d][1];
-                        if (c >= 0) {
-                            minVal += c * low;
-                            maxVal += c * high;
-                        } else {
-                            minVal += c * high;
-                            maxVal += c * low;
-                        }
+                // All sub-MBRs at once (float fast path, exact double where it is too close to call)
+                subMBRBoxes.classify(hsPtr->coeff, hsPtr->known, positions.data());
+                for (size_t j = 0; j < positions.size(); j++) {
+                    const int i = simplexSubMBRs[j];
+                    // A sub-MBR across sum(w) = 1 is classified by its part inside the simplex
+                    if (positions[j] == PositionHS::OVERLAPPED) {
+                        positions[j] = simplexPartPosition(hsPtr->coeff, hsPtr->known, precomputedSubMBRs[i]);
                     }
-
                     // "Fully covered" => store once in fully list
-                    if (maxVal < known) {
+                    if (positions[j] == PositionHS::BELOW) {
                         partialRes[t][i].fully.push_back(hsID);
                     }
                     // partial overlap => store in partial list
-                    else if (minVal <= known) {
+                    else if (positions[j] == PositionHS::OVERLAPPED) {
                         partialRes[t][i].partial.push_back(hsID);
                     }
                     // else => skip
@@ -188,51 +271,36 @@ void QTree::inserthalfspacesMacroSplit(const std::vector<long int>& halfspaces)
     }
 
     // 2) Build/Update sub-roots
-    std::vector<std::future<void>> buildFutures;
-    buildFutures.reserve(nSub);
-
+    std::vector<int> toBuild;
+    toBuild.reserve(nSub);
     for (int i = 0; i < nSub; i++) {
         // if no halfspace at all => skip
         if (fullyCovered[i].empty() && partialOverlapped[i].empty()) continue;
+        toBuild.push_back(i);
+    }
 
-        // **Memory saver**:
-        // If partialOverlapped[i] is empty => entire subMBR is fully covered,
-        // no need for a macro-root subtree.
-        if (partialOverlapped[i].empty()) {
-            // Optionally store these "fully covered" halfspaces in a global structure
-            // if you need them for later queries. Or just skip creation:
-            continue;
-        }
+    // Sub-roots are spread round-robin over at most hwThreads workers.
+    auto buildSubRoot = [this, &fullyCovered, &partialOverlapped](const int i) {
+        TRACE_SCOPE("buildMacroRoot", i);
+        // We add "fully covered" to subRoot->covered (delta coverage at this level)
+        macroRoots[i]->covered.insert(
+            macroRoots[i]->covered.end(),
+            fullyCovered[i].begin(),
+            fullyCovered[i].end()
+        );
+        // partial => insert
+        macroRoots[i]->insertHalfspaces(partialOverlapped[i]);
+    };
 
-        // Otherwise, partial coverage => we do need a macro-root
-        buildFutures.push_back(std::async(std::launch::async, [this, i, &fullyCovered, &partialOverlapped]() {
-            if (!macroRoots[i]) {
-                // Create a sub-root
-                QNode* subRoot = new QNode(const_cast<QTree*>(this),
-                                           nullptr,
-                                           precomputedSubMBRs[i],
-                                           1);
-
-                // "fully covered" => put in subRoot->covered
-                // (Delta coverage approach: these are newly discovered coverage at this root)
-                subRoot->covered.insert(subRoot->covered.end(),
-                                        fullyCovered[i].begin(),
-                                        fullyCovered[i].end());
-
-                // partial => insert halfspaces
-                subRoot->insertHalfspaces(partialOverlapped[i]);
-
-                macroRoots[i] = subRoot;
-            } else {
-                // existing subRoot =>
-                // We add "fully covered" to subRoot->covered (delta coverage at this level)
-                macroRoots[i]->covered.insert(
-                    macroRoots[i]->covered.end(),
-                    fullyCovered[i].begin(),
-                    fullyCovered[i].end()
-                );
-                // partial => insert
-                macroRoots[i]->insertHalfspaces(partialOverlapped[i]);
+    const size_t numWorkers = std::min<size_t>(hwThreads, toBuild.size());
+    std::vector<std::future<void>> buildFutures;
+    buildFutures.reserve(numWorkers);
+
+    for (size_t w = 0; w < numWorkers; w++) {
+        buildFutures.push_back(std::async(std::launch::async, [&toBuild, &buildSubRoot, w, numWorkers]() {
+            TRACE_SCOPE("buildWorker", static_cast<long long>(w));
+            for (size_t k = w; k < toBuild.size(); k += numWorkers) {
+                buildSubRoot(toBuild[k]);
             }
         }));
     }
@@ -268,6 +336,14 @@ std::vector<QNode*> QTree::getAllLeaves() const {
     return result;
 }
 
+void QTree::noteSplit() {
+    if (!queryBudget.enabled()) return;
+    // Reading the RSS at every split would cost more than the split itself
+    if (splitsSinceCheck.fetch_add(1, std::memory_order_relaxed) + 1 < MemoryBudget::budgetCheckSplits) return;
+    splitsSinceCheck.store(0, std::memory_order_relaxed);
+    if (queryBudget.near()) splitsFrozen.store(true, std::memory_order_relaxed);
+}
+
 void QTree::updateAllOrders() {
     // 1) Update root subtree if it exists
     if (root) {
@@ -2,90 +2,112 @@
 #include <algorithm>
 #include <cmath>
 
-// ------------------------------------------------------------------------
-// Existing helper functions (unchanged)
-// ------------------------------------------------------------------------
-std::vector<Point> getdominators(const std::vector<Point>& data, const Point& p)
+namespace {
+
+// Relazione di un record rispetto a un punto di riferimento, come bit:
+// minore in almeno una dimensione / maggiore in almeno una dimensione
+constexpr unsigned char relSmaller = 1;
+constexpr unsigned char relGreater = 2;
+constexpr unsigned char relDominator = relSmaller;                  // <= ovunque, < da qualche parte
+constexpr unsigned char relDominee = relGreater;                    // >= ovunque, > da qualche parte
+constexpr unsigned char relIncomparable = relSmaller | relGreater;  // 0 = coordinate uguali
+
+constexpr size_t tileLanes = 8;
+
+/**
+ * \brief Relazioni rispetto a ref dei record 0 ... count - 1 di un tile (count <= tileLanes),
+ *        scritte in rel[0 .. tileLanes); coordAt(l, d) è la coordinata d del record l.
+ *        Le coordinate vengono raccolte una dimensione alla volta, così i confronti girano
+ *        su tutte le lane insieme e senza salti (i cicli sulle lane vengono vettorizzati);
+ *        l'unico salto è l'uscita del tile quando tutte le lane sono incomparabili.
+ *        Le lane vuote valgono 0.
+ */
+template <typename CoordAt>
+void relationTile(const Point& ref, const size_t count, CoordAt coordAt, unsigned char* rel)
 {
-    std::vector<Point> dominators;
-    dominators.reserve(data.size() / 2);
-    for (const auto& r : data) {
-        bool less_equal    = true;
-        bool strictly_less = false;
-        for (int i = 0; i < p.dims; ++i) {
-            if (r.coord[i] > p.coord[i]) {
-                less_equal = false;
-                break;
-            }
-            if (r.coord[i] < p.coord[i]) {
-                strictly_less = true;
-            }
+    unsigned char smaller[tileLanes] = {};
+    unsigned char greater[tileLanes] = {};
+    double tile[tileLanes];
+    for (int d = 0; d < ref.dims; ++d) {
+        const double r = ref.coord[d];
+        for (size_t l = 0; l < tileLanes; ++l) {
+            tile[l] = l < count ? coordAt(l, d) : r;
         }
-        if (less_equal && strictly_less) {
-            dominators.push_back(r);
+        unsigned char settled = 1;
+        for (size_t l = 0; l < tileLanes; ++l) {
+            smaller[l] |= static_cast<unsigned char>(tile[l] < r);
+            greater[l] |= static_cast<unsigned char>(tile[l] > r);
+            settled &= smaller[l] & greater[l];
         }
+        // Tutte le lane incomparabili: le dimensioni restanti non cambiano nulla
+        if (settled) break;
+    }
+    for (size_t l = 0; l < tileLanes; ++l) {
+        rel[l] = static_cast<unsigned char>(smaller[l] | (greater[l] << 1));
     }
-    return dominators;
 }
 
-std::vector<Point> getdominees(const std::vector<Point>& data, const Point& p)
+/**
+ * \brief Punti di data con la relazione indicata rispetto a p, nell'ordine di data.
+ *        Gli indici vengono compattati senza salti: ogni lane scrive, solo le buone avanzano.
+ */
+std::vector<Point> selectRelation(const std::vector<Point>& data, const Point& p, const unsigned char relation)
 {
-    std::vector<Point> dominees;
-    dominees.reserve(data.size() / 2);
-    for (const auto& r : data) {
-        bool greater_equal = true;
-        bool strictly_greater = false;
-        for (int i = 0; i < p.dims; ++i) {
-            if (r.coord[i] < p.coord[i]) {
-                greater_equal = false;
-                break;
-            }
-            if (r.coord[i] > p.coord[i]) {
-                strictly_greater = true;
-            }
-        }
-        if (greater_equal && strictly_greater) {
-            dominees.push_back(r);
+    std::vector<size_t> selected(data.size());
+    size_t count = 0;
+    unsigned char rel[tileLanes];
+    for (size_t base = 0; base < data.size(); base += tileLanes) {
+        const size_t m = std::min(tileLanes, data.size() - base);
+        relationTile(p, m, [&](const size_t l, const int d) { return data[base + l].coord[d]; }, rel);
+        for (size_t l = 0; l < m; ++l) {
+            selected[count] = base + l;
+            count += rel[l] == relation;
         }
     }
-    return dominees;
+
+    std::vector<Point> points;
+    points.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        points.push_back(data[selected[i]]);
+    }
+    return points;
 }
 
-std::vector<Point> getincomparables(const std::vector<Point>& data, const Point& p)
+} // namespace
+
+DominancePartition getpartition(const std::vector<Point>& data, const Point& p)
 {
-    std::vector<Point> incomp;
-    incomp.reserve(data.size() / 2);
-    for (const auto& r : data) {
-        bool less = false;
-        bool greater = false;
-        for (int i = 0; i < p.dims; ++i) {
-            if (r.coord[i] < p.coord[i]) less = true;
-            if (r.coord[i] > p.coord[i]) greater = true;
-        }
-        if (less && greater) {
-            incomp.push_back(r);
+    DominancePartition part;
+    part.incomparables.resize(data.size());
+    size_t count = 0;
+    unsigned char rel[tileLanes];
+    for (size_t base = 0; base < data.size(); base += tileLanes) {
+        const size_t m = std::min(tileLanes, data.size() - base);
+        relationTile(p, m, [&](const size_t l, const int d) { return data[base + l].coord[d]; }, rel);
+        for (size_t l = 0; l < m; ++l) {
+            part.dominators += rel[l] == relDominator;
+            part.dominees += rel[l] == relDominee;
+            part.incomparables[count] = base + l;
+            count += rel[l] == relIncomparable;
         }
     }
-    return incomp;
+    part.incomparables.resize(count);
+    return part;
 }
 
-/**
- * \brief Controlla se p domina strettamente q (p < q in tutte le dim?).
- *        Ritorna true se p domina q.
- */
-static bool dominates(const Point& p, const Point& q)
+std::vector<Point> getdominators(const std::vector<Point>& data, const Point& p)
 {
-    bool strictlyLess = false;
-    for (int i = 0; i < p.dims; i++) {
-        if (p.coord[i] > q.coord[i]) {
-            // p non domina q
-            return false;
-        }
-        if (p.coord[i] < q.coord[i]) {
-            strictlyLess = true;
-        }
-    }
-    return strictlyLess;
+    return selectRelation(data, p, relDominator);
+}
+
+std::vector<Point> getdominees(const std::vector<Point>& data, const Point& p)
+{
+    return selectRelation(data, p, relDominee);
+}
+
+std::vector<Point> getincomparables(const std::vector<Point>& data, const Point& p)
+{
+    return selectRelation(data, p, relIncomparable);
 }
 
 /**
@@ -97,49 +119,116 @@ std::vector<Point> getskyline(const std::vector<Point>& data)
 {
     if (data.empty()) return {};
 
-    // 1) Prepara un vettore (punto, sumCoord) e ordina
-    std::vector<std::pair<Point, double>> arr;
+    // 1) Prepara un vettore (sumCoord, indice) e ordina
+    std::vector<std::pair<double, size_t>> arr;
     arr.reserve(data.size());
-    for (const auto& p : data) {
+    for (size_t i = 0; i < data.size(); i++) {
         double sum = 0.0;
-        for (double c : p.coord) {
+        for (double c : data[i].coord) {
             sum += c;
         }
-        arr.emplace_back(p, sum);
+        arr.emplace_back(sum, i);
     }
 
     // Ordiniamo in base a sumCoord (crescente)
     std::sort(arr.begin(), arr.end(),
               [](auto& a, auto& b){
-                  return a.second < b.second;
+                  return a.first < b.first;
               });
 
     // 2) Filtro incrementale per costruire la skyline
     std::vector<Point> sky;
     sky.reserve(data.size() / 10);
+    // Copia per colonne delle coordinate di sky, letta a tile contigui dal kernel
+    const int dims = data.front().dims;
+    std::vector<std::vector<double>> skyCols(dims);
+    std::vector<unsigned char> rel;   // relazioni dei punti di sky rispetto al punto corrente
 
-    for (auto &pairp : arr) {
-        Point p = pairp.first;
-        bool dominated = false;
+    for (const auto& pairp : arr) {
+        const Point& p = data[pairp.second];
 
         // Se p è dominato da uno qualunque in sky, scartiamo p
-        for (auto &sk : sky) {
-            if (dominates(sk, p)) {
-                dominated = true;
-                break;
+        rel.resize(sky.size() + tileLanes);
+        bool dominated = false;
+        for (size_t base = 0; base < sky.size() && !dominated; base += tileLanes) {
+            const size_t m = std::min(tileLanes, sky.size() - base);
+            relationTile(p, m, [&](const size_t l, const int d) { return skyCols[d][base + l]; }, rel.data() + base);
+            unsigned char any = 0;
+            for (size_t l = 0; l < tileLanes; ++l) {
+                any |= static_cast<unsigned char>(rel[base + l] == relDominator);
             }
+            dominated = any != 0;
         }
         if (!dominated) {
             // p non è dominato, lo aggiungiamo e
-            // rimuoviamo eventuali punti in sky che p domina
-            sky.erase(std::remove_if(sky.begin(), sky.end(),
-                                     [&](const Point &x){
-                                         return dominates(p, x);
-                                     }),
-                      sky.end());
+            // rimuoviamo i punti in sky che p domina (le relazioni sono già calcolate)
+            size_t kept = 0;
+            for (size_t i = 0; i < sky.size(); i++) {
+                if (rel[i] == relDominee) continue;
+                if (kept != i) {
+                    sky[kept] = std::move(sky[i]);
+                    for (auto& col : skyCols) col[kept] = col[i];
+                }
+                kept++;
+            }
+            sky.erase(sky.begin() + static_cast<std::ptrdiff_t>(kept), sky.end());
+            for (int d = 0; d < dims; d++) {
+                skyCols[d].resize(kept);
+                skyCols[d].push_back(p.coord[d]);
+            }
             sky.push_back(p);
         }
     }
 
     return sky;
-}
\ No newline at end of file
+}
+
+/**
+ * \brief k-skyband con lo stesso ordinamento di getskyline (somma delle coordinate).
+ *        Un dominatore ha somma minore, quindi è già stato visto; basta contare i
+ *        dominatori nella banda: chi ne ha k o più fuori dalla banda ne ha k anche dentro.
+ */
+std::vector<Point> getkskyband(const std::vector<Point>& data, const int k)
+{
+    if (data.empty() || k <= 0) return {};
+
+    std::vector<std::pair<double, size_t>> arr;
+    arr.reserve(data.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        double sum = 0.0;
+        for (double c : data[i].coord) {
+            sum += c;
+        }
+        arr.emplace_back(sum, i);
+    }
+    std::stable_sort(arr.begin(), arr.end(),
+                     [](const auto& a, const auto& b) {
+                         return a.first < b.first;
+                     });
+
+    std::vector<size_t> band;
+    std::vector<char> inBand(data.size(), 0);
+    unsigned char rel[tileLanes];
+    for (const auto& [sum, i] : arr) {
+        int count = 0;
+        for (size_t base = 0; base < band.size() && count < k; base += tileLanes) {
+            const size_t m = std::min(tileLanes, band.size() - base);
+            relationTile(data[i], m, [&](const size_t l, const int d) { return data[band[base + l]].coord[d]; }, rel);
+            for (size_t l = 0; l < tileLanes; ++l) {
+                count += rel[l] == relDominator;
+            }
+        }
+        if (count < k) {
+            band.push_back(i);
+            inBand[i] = 1;
+        }
+    }
+
+    // Stesso ordine dell'input, così gli id degli halfspaces non cambiano ordine
+    std::vector<Point> result;
+    result.reserve(band.size());
+    for (size_t i = 0; i < data.size(); i++) {
+        if (inBand[i]) result.push_back(data[i]);
+    }
+    return result;
+}
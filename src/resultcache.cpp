@@ -0,0 +1,204 @@
+#include "resultcache.h"
+#include "config.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/file.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+constexpr uint64_t fnvOffset = 14695981039346656037ULL;
+constexpr uint64_t fnvPrime = 1099511628211ULL;
+const std::string cacheHeader = "# maxrank result cache v1 ";
+
+void fnvMix(uint64_t& h, const void* bytes, const size_t n) {
+    const auto* p = static_cast<const unsigned char*>(bytes);
+    for (size_t i = 0; i < n; i++) {
+        h ^= p[i];
+        h *= fnvPrime;
+    }
+}
+
+std::string toHex(const uint64_t v) {
+    std::ostringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << v;
+    return ss.str();
+}
+
+/**
+ * Advisory lock held on "<cache file>.lock" for the lifetime of the object.
+ */
+class FileLock {
+public:
+    FileLock(const std::string& lockPath, const bool exclusive) {
+#if defined(_WIN32)
+        handle = CreateFileA(lockPath.c_str(), GENERIC_READ | GENERIC_WRITE,
+                             FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, OPEN_ALWAYS,
+                             FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE) {
+            throw std::runtime_error("Could not open lock file: " + lockPath);
+        }
+        OVERLAPPED ov = {};
+        if (!LockFileEx(handle, exclusive ? LOCKFILE_EXCLUSIVE_LOCK : 0, 0, MAXDWORD, MAXDWORD, &ov)) {
+            CloseHandle(handle);
+            throw std::runtime_error("Could not lock file: " + lockPath);
+        }
+#else
+        fd = open(lockPath.c_str(), O_RDWR | O_CREAT, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("Could not open lock file: " + lockPath);
+        }
+        if (flock(fd, exclusive ? LOCK_EX : LOCK_SH) != 0) {
+            close(fd);
+            throw std::runtime_error("Could not lock file: " + lockPath);
+        }
+#endif
+    }
+
+    ~FileLock() {
+#if defined(_WIN32)
+        OVERLAPPED ov = {};
+        UnlockFileEx(handle, 0, MAXDWORD, MAXDWORD, &ov);
+        CloseHandle(handle);
+#else
+        flock(fd, LOCK_UN);
+        close(fd);
+#endif
+    }
+
+    FileLock(const FileLock&) = delete;
+    FileLock& operator=(const FileLock&) = delete;
+
+private:
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    int fd;
+#endif
+};
+
+} // namespace
+
+uint64_t hashDataset(const std::vector<Point>& data) {
+    uint64_t h = fnvOffset;
+    const uint64_t n = data.size();
+    fnvMix(h, &n, sizeof(n));
+    for (const auto& p : data) {
+        fnvMix(h, &p.id, sizeof(p.id));
+        for (const double c : p.coord) {
+            uint64_t bits;
+            std::memcpy(&bits, &c, sizeof(bits));
+            fnvMix(h, &bits, sizeof(bits));
+        }
+    }
+    return h;
+}
+
+std::string resultCacheParams(const std::string& engine, const int rankThreshold) {
+    // Only what can change a result: threads, output and diagnostics flags are left out
+    return "version=" + std::to_string(resultEngineVersion) +
+           ";engine=" + engine +
+           ";limitHamWeight=" + std::to_string(limitHamWeight) +
+           ";maxLevelQTree=" + std::to_string(maxLevelQTree) +
+           ";maxCapacityQNode=" + std::to_string(maxCapacityQNode) +
+           ";qtreeSplit=" + std::to_string(qtreeSplit) +
+           ";splitPosition=" + std::to_string(splitPosition) +
+           ";maxNoBinStringToCheck=" + std::to_string(maxNoBinStringToCheck) +
+           ";halfspacesLengthLimit=" + std::to_string(halfspacesLengthLimit) +
+           ";rankThreshold=" + std::to_string(rankThreshold) +
+           ";boundSamples=" + std::to_string(boundSamples);
+}
+
+ResultCache::ResultCache(const std::string& dir, const uint64_t dataHash, const std::string& params)
+    : params(params)
+{
+    std::filesystem::create_directories(dir);
+    uint64_t paramHash = fnvOffset;
+    fnvMix(paramHash, params.data(), params.size());
+    filename = (std::filesystem::path(dir) / (toHex(dataHash) + "_" + toHex(paramHash) + ".cache")).string();
+    load();
+}
+
+void ResultCache::load() {
+    const FileLock lock(filename + ".lock", true);
+
+    std::ifstream in(filename);
+    if (!in.is_open()) {
+        // First run with this dataset and parameters: create the file with its header
+        std::ofstream out(filename);
+        if (!out.is_open()) {
+            throw std::runtime_error("Could not create result cache: " + filename);
+        }
+        out << cacheHeader << params << "\n";
+        return;
+    }
+
+    std::string line;
+    if (!std::getline(in, line) || line != cacheHeader + params) {
+        throw std::runtime_error("Result cache " + filename + " belongs to different parameters");
+    }
+    // Line format: "<id> <maxrank> <n> <v1> ... <vn> $"
+    while (std::getline(in, line)) {
+        std::istringstream ss(line);
+        int id, n;
+        CachedResult res;
+        if (!(ss >> id >> res.maxrank >> n) || n < 0) continue;
+        res.witness.resize(n);
+        bool ok = true;
+        for (auto& v : res.witness) {
+            std::string tok;
+            if (!(ss >> tok)) { ok = false; break; }
+            v = std::strtod(tok.c_str(), nullptr);
+        }
+        std::string end;
+        if (ok && ss >> end && end == "$") {
+            entries[id] = std::move(res);
+        }
+    }
+}
+
+bool ResultCache::lookup(const int id, CachedResult& out) const {
+    const auto it = entries.find(id);
+    if (it == entries.end()) return false;
+    out = it->second;
+    return true;
+}
+
+void ResultCache::store(const int id, const CachedResult& result) {
+    entries[id] = result;
+
+    std::ostringstream line;
+    line << std::setprecision(17) << id << " " << result.maxrank << " " << result.witness.size();
+    for (const double v : result.witness) line << " " << v;
+    line << " $\n";
+
+    const FileLock lock(filename + ".lock", true);
+
+    // A writer that crashed mid-line leaves no newline: start on a fresh line, otherwise
+    // the torn line and this one would be read as a single (wrong) result
+    bool freshLine = true;
+    {
+        std::ifstream in(filename, std::ios::binary | std::ios::ate);
+        if (in.is_open() && in.tellg() > 0) {
+            in.seekg(-1, std::ios::end);
+            freshLine = in.get() == '\n';
+        }
+    }
+
+    std::ofstream out(filename, std::ios::app);
+    if (!out.is_open()) {
+        throw std::runtime_error("Could not append to result cache: " + filename);
+    }
+    if (!freshLine) out << "\n";
+    out << line.str();
+}
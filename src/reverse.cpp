@@ -0,0 +1,103 @@
+#include "reverse.h"
+#include "batch2d.h"
+#include "config.h"
+#include "dominanceindex.h"
+#include "maxrank.h"
+#include "query.h"
+#include "sampling.h"
+#include <algorithm>
+#include <memory>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace {
+
+// Same weights and tie handling as the sampled bound of aa_hd
+constexpr unsigned int reverseSeed = 42;
+constexpr double reverseTieEps = 1e-9;
+
+} // namespace
+
+std::vector<ReverseMatch> reverseMaxRank(const std::vector<Point>& data, const int k, ReverseStats* stats) {
+    if (k < 1) {
+        throw std::invalid_argument("Reverse query rank must be >= 1, got " + std::to_string(k));
+    }
+    ReverseStats st;
+    st.records = data.size();
+    std::vector<ReverseMatch> matches;
+    if (data.empty()) {
+        if (stats) *stats = st;
+        return matches;
+    }
+    const int dims = data.front().dims;
+
+    std::unordered_map<int, size_t> position;
+    position.reserve(data.size());
+    for (size_t i = 0; i < data.size(); i++) position[data[i].id] = i;
+
+    // 1) k-skyband: records with k or more dominators rank below them under every weighting
+    std::vector<size_t> candidates;
+    for (const auto& r : getkskyband(data, k)) candidates.push_back(position.at(r.id));
+    st.candidates = candidates.size();
+
+    // 2) One sampling pass for all candidates
+    std::vector<size_t> remaining;
+    if (boundSamples > 0) {
+        const RankSampler sampler(data, dims);
+        const auto best = sampler.bestForRecords(candidates, sampleSimplexWeights(dims, boundSamples, reverseSeed),
+                                                 reverseTieEps);
+        for (size_t c = 0; c < candidates.size(); c++) {
+            const int rank = best[c].below + 1;
+            if (rank > k) {
+                remaining.push_back(candidates[c]);
+                continue;
+            }
+            if (rank == 1) st.hull++;
+            st.sampled++;
+            matches.push_back({data[candidates[c]].id, rank, best[c].weights, true});
+        }
+    } else {
+        remaining = candidates;
+    }
+    st.searched = remaining.size();
+
+    // 3) Decision queries for the rest
+    if (dims > 2) {
+        // The sampling pass already tried the same weights
+        ScopedGlobal<int> noSampling(boundSamples, 0);
+        // The decision queries share one dominance index instead of scanning the data each
+        std::unique_ptr<DominanceIndex> index;
+        if (dominanceIndex && remaining.size() >= dominanceIndexMinQueries) index = std::make_unique<DominanceIndex>(data);
+        ScopedGlobal<const DominanceIndex*> useIndex(activeDominanceIndex, index ? index.get() : activeDominanceIndex);
+        for (const size_t i : remaining) {
+            auto [rank, cells] = aa_hd(data, data[i], k);
+            if (rank > k) continue;
+            std::vector<double> witness;
+            if (!cells.empty()) {
+                witness = cells.front().feasible_pnt.coord;
+                witness.push_back(1 - std::accumulate(witness.begin(), witness.end(), 0.0));
+            }
+            matches.push_back({data[i].id, rank, std::move(witness), false});
+        }
+    } else if (!remaining.empty()) {
+        std::vector<int> queries;
+        queries.reserve(remaining.size());
+        for (const size_t i : remaining) queries.push_back(static_cast<int>(i) + 1);
+        const std::vector<Result2D> results = aa_2d_batch(data, queries);
+        for (size_t q = 0; q < remaining.size(); q++) {
+            if (results[q].maxrank > k) continue;
+            std::vector<double> witness;
+            if (!results[q].ranges.empty()) {
+                const double w1 = (results[q].ranges.front().first + results[q].ranges.front().second) / 2;
+                witness = {w1, 1 - w1};
+            }
+            matches.push_back({data[remaining[q]].id, results[q].maxrank, std::move(witness), false});
+        }
+    }
+
+    std::sort(matches.begin(), matches.end(), [](const ReverseMatch& a, const ReverseMatch& b) { return a.id < b.id; });
+    st.matches = matches.size();
+    if (stats) *stats = st;
+    return matches;
+}
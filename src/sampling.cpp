@@ -0,0 +1,148 @@
+#include "sampling.h"
+#include "config.h"
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <random>
+
+std::vector<std::vector<double>> sampleSimplexWeights(const int dims, const int samples, const unsigned int seed) {
+    std::vector<std::vector<double>> weights;
+    weights.reserve(dims + 1 + std::max(samples, 0));
+
+    // Structured weights: vertices and centroid of the simplex
+    for (int d = 0; d < dims; ++d) {
+        std::vector<double> w(dims, 0.0);
+        w[d] = 1.0;
+        weights.push_back(w);
+    }
+    weights.emplace_back(dims, 1.0 / dims);
+
+    // Uniform weights on the simplex; one in three lies on a random face
+    std::mt19937 gen(seed);
+    std::exponential_distribution<double> expo(1.0);
+    std::bernoulli_distribution onFace(1.0 / 3.0);
+    for (int s = 0; s < samples; ++s) {
+        std::vector<double> w(dims);
+        double sum = 0.0;
+        const bool face = onFace(gen);
+        for (int d = 0; d < dims; ++d) {
+            w[d] = (face && onFace(gen)) ? 0.0 : expo(gen);
+            sum += w[d];
+        }
+        if (sum <= 0.0) continue;
+        for (auto& v : w) v /= sum;
+        weights.push_back(std::move(w));
+    }
+    return weights;
+}
+
+RankSampler::RankSampler(const std::vector<Point>& records, const int dims)
+    : n(records.size()), dims(dims), cols(dims, std::vector<double>(records.size()))
+{
+    for (size_t i = 0; i < n; ++i) {
+        for (int d = 0; d < dims; ++d) cols[d][i] = records[i].coord[d];
+    }
+}
+
+SampledRank RankSampler::best(const Point& p, const std::vector<std::vector<double>>& weights,
+                              const double tolerance) const {
+    constexpr size_t block = 16;
+    std::vector<double> scores(block * n);
+    SampledRank result;
+    int best = std::numeric_limits<int>::max();
+    size_t bestIndex = 0;
+
+    for (size_t w0 = 0; w0 < weights.size(); w0 += block) {
+        const size_t wn = std::min(block, weights.size() - w0);
+        std::fill(scores.begin(), scores.begin() + static_cast<std::ptrdiff_t>(wn * n), 0.0);
+        for (size_t k = 0; k < wn; ++k) {
+            const auto& w = weights[w0 + k];
+            double* row = scores.data() + k * n;
+            for (int d = 0; d < dims; ++d) {
+                const double wd = w[d];
+                const double* col = cols[d].data();
+                for (size_t i = 0; i < n; ++i) row[i] += wd * col[i];
+            }
+            double ps = 0.0;
+            for (int d = 0; d < dims; ++d) ps += w[d] * p.coord[d];
+            const double threshold = ps + tolerance;
+            int below = 0;
+            for (size_t i = 0; i < n; ++i) below += (row[i] < threshold) ? 1 : 0;
+            if (below < best) {
+                best = below;
+                bestIndex = w0 + k;
+            }
+        }
+        if (best == 0) break;  // cannot do better
+    }
+
+    if (!weights.empty()) {
+        result.below = best;
+        result.weights = weights[bestIndex];
+    }
+    return result;
+}
+
+std::vector<SampledRank> RankSampler::bestForRecords(const std::vector<size_t>& targets,
+                                                     const std::vector<std::vector<double>>& weights,
+                                                     const double tolerance) const {
+    struct Best {
+        int below = std::numeric_limits<int>::max();
+        size_t weight = 0;
+    };
+    // A target's own score is below score + tolerance when tolerance > 0
+    const int self = tolerance > 0.0 ? 1 : 0;
+
+    // Each thread scans a contiguous range of weight vectors with its own buffers
+    auto scan = [&](const size_t wBegin, const size_t wEnd) {
+        constexpr size_t block = 16;
+        std::vector<Best> best(targets.size());
+        std::vector<double> scores(block * n);
+        std::vector<double> sorted(n);
+        for (size_t w0 = wBegin; w0 < wEnd; w0 += block) {
+            const size_t wn = std::min(block, wEnd - w0);
+            std::fill(scores.begin(), scores.begin() + static_cast<std::ptrdiff_t>(wn * n), 0.0);
+            for (size_t k = 0; k < wn; ++k) {
+                const auto& w = weights[w0 + k];
+                double* row = scores.data() + k * n;
+                for (int d = 0; d < dims; ++d) {
+                    const double wd = w[d];
+                    const double* col = cols[d].data();
+                    for (size_t i = 0; i < n; ++i) row[i] += wd * col[i];
+                }
+                std::copy(row, row + n, sorted.begin());
+                std::sort(sorted.begin(), sorted.end());
+                for (size_t t = 0; t < targets.size(); ++t) {
+                    const double threshold = row[targets[t]] + tolerance;
+                    const int below = static_cast<int>(std::lower_bound(sorted.begin(), sorted.end(), threshold) - sorted.begin()) - self;
+                    if (below < best[t].below) best[t] = {below, w0 + k};
+                }
+            }
+        }
+        return best;
+    };
+
+    const size_t threads = std::max<size_t>(1, std::min<size_t>(workerThreads(), weights.size()));
+    const size_t chunk = (weights.size() + threads - 1) / threads;
+    std::vector<std::future<std::vector<Best>>> futures;
+    for (size_t begin = 0; begin < weights.size(); begin += chunk) {
+        futures.push_back(std::async(std::launch::async, scan, begin, std::min(begin + chunk, weights.size())));
+    }
+
+    // Merge in weight order, so ties keep the first weight vector whatever the thread count
+    std::vector<Best> best(targets.size());
+    for (auto& f : futures) {
+        const std::vector<Best> part = f.get();
+        for (size_t t = 0; t < targets.size(); ++t) {
+            if (part[t].below < best[t].below) best[t] = part[t];
+        }
+    }
+
+    std::vector<SampledRank> result(targets.size());
+    for (size_t t = 0; t < targets.size(); ++t) {
+        if (weights.empty()) continue;
+        result[t].below = best[t].below;
+        result[t].weights = weights[best[t].weight];
+    }
+    return result;
+}
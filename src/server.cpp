@@ -0,0 +1,429 @@
+#include "server.h"
+#include "config.h"
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Longest request line accepted (a "point" line of a few hundred dimensions fits easily)
+constexpr size_t maxLineLength = 1 << 16;
+// Poll period of blocking waits, i.e. how quickly stop() is noticed
+constexpr int pollMillis = 200;
+
+std::string formatAnswer(const CachedResult& r) {
+    std::ostringstream ss;
+    ss << std::setprecision(17) << "ok " << r.maxrank;
+    for (const double v : r.witness) ss << " " << v;
+    return ss.str();
+}
+
+#if !defined(_WIN32)
+bool writeAll(const int fd, const std::string& s) {
+    size_t done = 0;
+    while (done < s.size()) {
+        const ssize_t n = write(fd, s.data() + done, s.size() - done);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        done += static_cast<size_t>(n);
+    }
+    return true;
+}
+
+sockaddr_un socketAddress(const std::string& socketPath) {
+    sockaddr_un addr{};
+    if (socketPath.size() >= sizeof(addr.sun_path)) {
+        throw std::runtime_error("Socket path too long: " + socketPath);
+    }
+    addr.sun_family = AF_UNIX;
+    std::strncpy(addr.sun_path, socketPath.c_str(), sizeof(addr.sun_path) - 1);
+    return addr;
+}
+#endif
+
+} // namespace
+
+MaxRankServer::MaxRankServer(const std::vector<Point>& data, const int workers, const int queueLimit, ResultCache* cache)
+    : dataset(data), dims(data.empty() ? 0 : data.front().coord.size()),
+      workers(std::max(workers, 1)), queueLimit(std::max(queueLimit, 0)), cache(cache),
+      started(std::chrono::steady_clock::now()), recordCount(data.size())
+{
+    // The result cache is keyed by query index (data[q - 1]), requests by record id:
+    // share it only when they coincide
+    for (size_t i = 0; i < data.size() && this->cache; i++) {
+        if (data[i].id != static_cast<int>(i) + 1) this->cache = nullptr;
+    }
+}
+
+MaxRankServer::~MaxRankServer() {
+    stopping = true;
+    queueReady.notify_all();
+    for (auto& t : pool) {
+        if (t.joinable()) t.join();
+    }
+}
+
+void MaxRankServer::recordQueryTime(const std::chrono::steady_clock::time_point start) {
+    const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    const std::lock_guard<std::mutex> statsLock(statsMutex);
+    counters.totalQuerySeconds += elapsed.count();
+    counters.maxQuerySeconds = std::max(counters.maxQuerySeconds, elapsed.count());
+}
+
+std::vector<double> MaxRankServer::parseCoords(std::istringstream& ss, const size_t count) const {
+    std::vector<double> coord;
+    std::string tok;
+    while (ss >> tok) {
+        char* end = nullptr;
+        const double v = std::strtod(tok.c_str(), &end);
+        if (*end != '\0' || !std::isfinite(v)) throw std::invalid_argument("invalid coordinate: " + tok);
+        coord.push_back(v);
+    }
+    if (coord.size() != count) {
+        throw std::invalid_argument("expected " + std::to_string(count) + " coordinates, got " + std::to_string(coord.size()));
+    }
+    return coord;
+}
+
+std::string MaxRankServer::update(const std::string& cmd, std::istringstream& ss) {
+    const std::lock_guard<std::mutex> engine(engineMutex);
+    const std::lock_guard<std::mutex> lock(memoMutex);
+
+    // Results answered from the persistent cache are tracked from now on
+    for (const auto& [q, r] : toAdopt) {
+        if (dataset.record(q)) dataset.adopt(q, r);
+    }
+    toAdopt.clear();
+
+    const UpdateStats before = dataset.stats();
+    int id;
+    if (cmd == "insert") {
+        // "insert <c1> ... <cd>" or "insert id=<id> <c1> ... <cd>": the id is named, so a
+        // missing coordinate is an error rather than a different record
+        std::string rest;
+        std::getline(ss, rest);
+        std::istringstream coords(rest);
+        std::string first;
+        id = -1;
+        if (coords >> first && first.rfind("id=", 0) == 0) {
+            char* end = nullptr;
+            const long v = std::strtol(first.c_str() + 3, &end, 10);
+            if (first.size() == 3 || *end != '\0' || v < 0 || v > std::numeric_limits<int>::max()) {
+                throw std::invalid_argument("invalid record id: " + first);
+            }
+            id = static_cast<int>(v);
+        } else {
+            coords = std::istringstream(rest);
+        }
+        id = dataset.insert(parseCoords(coords, dims), id);
+    } else {
+        std::string extra;
+        if (!(ss >> id) || ss >> extra) throw std::invalid_argument("usage: delete <id>");
+        dataset.remove(id);
+    }
+    // The dataset no longer matches the hash of the persistent cache
+    cache = nullptr;
+    recordCount = dataset.records().size();
+
+    memo.clear();
+    for (const auto& [q, t] : dataset.tracked()) {
+        if (!t.stale) memo[q] = t.result;
+    }
+
+    const UpdateStats& after = dataset.stats();
+    std::ostringstream out;
+    out << "ok " << id << " records=" << dataset.records().size()
+        << " shifted=" << after.shifted - before.shifted
+        << " unaffected=" << after.unaffected - before.unaffected
+        << " invalidated=" << after.invalidated - before.invalidated
+        << " dropped=" << after.dropped - before.dropped;
+    const std::lock_guard<std::mutex> statsLock(statsMutex);
+    counters.updates++;
+    return out.str();
+}
+
+std::string MaxRankServer::handle(const std::string& line, bool& quit) {
+    std::istringstream ss(line);
+    std::string cmd;
+    if (!(ss >> cmd)) return "";
+    {
+        const std::lock_guard<std::mutex> lock(statsMutex);
+        counters.requests++;
+    }
+
+    try {
+        if (cmd == "rank") {
+            int q;
+            std::string extra;
+            if (!(ss >> q) || ss >> extra) throw std::invalid_argument("usage: rank <id>");
+
+            CachedResult r;
+            bool hit;
+            {
+                const std::lock_guard<std::mutex> lock(memoMutex);
+                const auto it = memo.find(q);
+                hit = it != memo.end();
+                if (hit) r = it->second;
+                else if (cache && cache->lookup(q, r)) {
+                    hit = true;
+                    memo[q] = r;
+                    toAdopt.emplace_back(q, r);
+                }
+            }
+            if (!hit) {
+                const std::lock_guard<std::mutex> engine(engineMutex);
+                // Another connection may have answered the same id while this one waited
+                {
+                    const std::lock_guard<std::mutex> lock(memoMutex);
+                    const auto it = memo.find(q);
+                    hit = it != memo.end();
+                    if (hit) r = it->second;
+                }
+                if (!hit) {
+                    const auto start = std::chrono::steady_clock::now();
+                    const TrackedQuery& t = dataset.query(q);
+                    r = t.result;
+                    recordQueryTime(start);
+                    // A result degraded by the memory budget may be an upper bound: neither memoized nor cached
+                    if (!t.budgetHit) {
+                        const std::lock_guard<std::mutex> lock(memoMutex);
+                        memo[q] = r;
+                        if (cache) cache->store(q, r);
+                    }
+                }
+            }
+            const std::lock_guard<std::mutex> lock(statsMutex);
+            counters.rankQueries++;
+            if (hit) counters.memoHits++;
+            return formatAnswer(r);
+        }
+        if (cmd == "point") {
+            const Point p(parseCoords(ss, dims));
+            CachedResult r;
+            {
+                const std::lock_guard<std::mutex> engine(engineMutex);
+                const auto start = std::chrono::steady_clock::now();
+                r = DynamicDataset::compute(dataset.records(), p).result;
+                recordQueryTime(start);
+            }
+            const std::lock_guard<std::mutex> lock(statsMutex);
+            counters.pointQueries++;
+            return formatAnswer(r);
+        }
+        if (cmd == "insert" || cmd == "delete") return update(cmd, ss);
+        if (cmd == "stats") return formatStats();
+        if (cmd == "quit") {
+            quit = true;
+            return "ok bye";
+        }
+        if (cmd == "shutdown") {
+            quit = true;
+            stop();
+            return "ok shutting down";
+        }
+        throw std::invalid_argument("unknown request: " + cmd);
+    } catch (const std::exception& e) {
+        const std::lock_guard<std::mutex> lock(statsMutex);
+        counters.errors++;
+        return std::string("err ") + e.what();
+    }
+}
+
+ServerStats MaxRankServer::stats() const {
+    const std::lock_guard<std::mutex> lock(statsMutex);
+    return counters;
+}
+
+std::string MaxRankServer::formatStats() const {
+    const ServerStats s = stats();
+    const std::chrono::duration<double> uptime = std::chrono::steady_clock::now() - started;
+    const long computed = s.rankQueries + s.pointQueries - s.memoHits;
+
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(3)
+       << "stats records=" << recordCount
+       << " workers=" << workers
+       << " uptime_s=" << uptime.count()
+       << " requests=" << s.requests
+       << " rank=" << s.rankQueries
+       << " point=" << s.pointQueries
+       << " memo_hits=" << s.memoHits
+       << " updates=" << s.updates
+       << " errors=" << s.errors
+       << " connections=" << s.connections
+       << " active=" << s.activeConnections
+       << " queued=" << s.queuedConnections
+       << " mean_query_s=" << (computed > 0 ? s.totalQuerySeconds / static_cast<double>(computed) : 0.0)
+       << " max_query_s=" << s.maxQuerySeconds;
+    return ss.str();
+}
+
+void MaxRankServer::serveStream(std::istream& in, std::ostream& out) {
+    std::string line;
+    bool quit = false;
+    while (!quit && std::getline(in, line)) {
+        const std::string response = handle(line, quit);
+        if (!response.empty()) out << response << std::endl;
+    }
+}
+
+#if !defined(_WIN32)
+
+void MaxRankServer::serveConnection(const int fd) {
+    std::string buffer;
+    char chunk[4096];
+    bool quit = false;
+    while (!quit && !stopping) {
+        pollfd pfd{fd, POLLIN, 0};
+        const int ready = poll(&pfd, 1, pollMillis);
+        if (ready < 0 && errno != EINTR) break;
+        if (ready <= 0) continue;
+
+        const ssize_t n = read(fd, chunk, sizeof(chunk));
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        buffer.append(chunk, static_cast<size_t>(n));
+
+        size_t eol;
+        while (!quit && (eol = buffer.find('\n')) != std::string::npos) {
+            std::string line = buffer.substr(0, eol);
+            buffer.erase(0, eol + 1);
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            const std::string response = handle(line, quit);
+            if (!response.empty() && !writeAll(fd, response + "\n")) quit = true;
+        }
+        if (buffer.size() > maxLineLength) {
+            writeAll(fd, "err request line too long\n");
+            break;
+        }
+    }
+    close(fd);
+}
+
+void MaxRankServer::workerLoop() {
+    while (true) {
+        int fd;
+        {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            queueReady.wait_for(lock, std::chrono::milliseconds(pollMillis), [&] { return stopping || !pending.empty(); });
+            if (stopping) return;
+            if (pending.empty()) continue;
+            fd = pending.front();
+            pending.pop_front();
+        }
+        {
+            const std::lock_guard<std::mutex> lock(statsMutex);
+            counters.queuedConnections--;
+            counters.activeConnections++;
+        }
+        serveConnection(fd);
+        {
+            const std::lock_guard<std::mutex> lock(queueMutex);
+            admitted--;
+        }
+        const std::lock_guard<std::mutex> lock(statsMutex);
+        counters.activeConnections--;
+    }
+}
+
+void MaxRankServer::serveSocket(const std::string& socketPath) {
+    // A client that disconnects early must not kill the server on the next write
+    std::signal(SIGPIPE, SIG_IGN);
+
+    const sockaddr_un addr = socketAddress(socketPath);
+    const int listenFd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        throw std::runtime_error("Could not create socket: " + std::string(std::strerror(errno)));
+    }
+    unlink(socketPath.c_str());
+    if (bind(listenFd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0 || listen(listenFd, 64) != 0) {
+        const std::string err = std::strerror(errno);
+        close(listenFd);
+        throw std::runtime_error("Could not listen on " + socketPath + ": " + err);
+    }
+
+    stopping = false;
+    for (int i = 0; i < workers; i++) pool.emplace_back(&MaxRankServer::workerLoop, this);
+
+    while (!stopping) {
+        pollfd pfd{listenFd, POLLIN, 0};
+        const int ready = poll(&pfd, 1, pollMillis);
+        if (ready <= 0) continue;
+        const int fd = accept(listenFd, nullptr, nullptr);
+        if (fd < 0) continue;
+
+        // Idle workers take connections first: queueLimit only bounds those left waiting
+        std::unique_lock<std::mutex> lock(queueMutex);
+        if (admitted >= workers + queueLimit) {
+            lock.unlock();
+            writeAll(fd, "err server busy\n");
+            close(fd);
+            continue;
+        }
+        {
+            const std::lock_guard<std::mutex> statsLock(statsMutex);
+            counters.connections++;
+            counters.queuedConnections++;
+        }
+        pending.push_back(fd);
+        admitted++;
+        lock.unlock();
+        queueReady.notify_one();
+    }
+
+    // Workers notice `stopping` within pollMillis, also in the middle of a connection
+    queueReady.notify_all();
+    for (auto& t : pool) t.join();
+    pool.clear();
+    for (const int fd : pending) close(fd);
+    pending.clear();
+    admitted = 0;
+    close(listenFd);
+    unlink(socketPath.c_str());
+}
+
+int connectServer(const std::string& socketPath) {
+    const sockaddr_un addr = socketAddress(socketPath);
+    const int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) {
+        throw std::runtime_error("Could not create socket: " + std::string(std::strerror(errno)));
+    }
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+        const std::string err = std::strerror(errno);
+        close(fd);
+        throw std::runtime_error("Could not connect to " + socketPath + ": " + err);
+    }
+    return fd;
+}
+
+#else
+
+void MaxRankServer::serveConnection(int) {}
+
+void MaxRankServer::workerLoop() {}
+
+void MaxRankServer::serveSocket(const std::string&) {
+    throw std::runtime_error("Unix domain sockets are not supported on this platform, use the stdin protocol");
+}
+
+int connectServer(const std::string&) {
+    throw std::runtime_error("Unix domain sockets are not supported on this platform");
+}
+
+#endif
@@ -0,0 +1,103 @@
+#include "trace.h"
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    long long arg;
+    long long startNs;  // relative to traceEpoch
+    long long durNs;
+};
+
+struct ThreadBuffer {
+    int tid = 0;
+    std::vector<TraceEvent> events;
+};
+
+const std::chrono::steady_clock::time_point traceEpoch = std::chrono::steady_clock::now();
+
+std::mutex registryMutex;
+std::vector<std::unique_ptr<ThreadBuffer>> buffers;  // every buffer ever created (owned here)
+std::vector<ThreadBuffer*> freeBuffers;              // buffers of threads that have exited
+
+// Binds a buffer to the calling thread and gives it back when the thread exits
+struct ThreadSlot {
+    ThreadBuffer* buffer = nullptr;
+
+    ThreadBuffer& get() {
+        if (!buffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            if (!freeBuffers.empty()) {
+                buffer = freeBuffers.back();
+                freeBuffers.pop_back();
+            } else {
+                buffers.push_back(std::make_unique<ThreadBuffer>());
+                buffer = buffers.back().get();
+                buffer->tid = static_cast<int>(buffers.size());
+                buffer->events.reserve(1024);
+            }
+        }
+        return *buffer;
+    }
+
+    ~ThreadSlot() {
+        if (buffer) {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            freeBuffers.push_back(buffer);
+        }
+    }
+};
+
+thread_local ThreadSlot threadSlot;
+
+long long nsSinceEpoch(const std::chrono::steady_clock::time_point& t) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t - traceEpoch).count();
+}
+
+} // namespace
+
+TraceSpan::~TraceSpan() {
+    const auto end = std::chrono::steady_clock::now();
+    threadSlot.get().events.push_back({name, arg, nsSinceEpoch(start), nsSinceEpoch(end) - nsSinceEpoch(start)});
+}
+
+void writeTrace(const std::string& filename) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        throw std::runtime_error("Could not open file: " + filename);
+    }
+
+    std::lock_guard<std::mutex> lock(registryMutex);
+    file << std::fixed << std::setprecision(3);
+    file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    bool first = true;
+    for (const auto& buf : buffers) {
+        // Track names: the first buffer always belongs to the thread that started tracing
+        file << (first ? "" : ",\n")
+             << R"({"name":"thread_name","ph":"M","pid":1,"tid":)" << buf->tid
+             << R"(,"args":{"name":")" << (buf->tid == 1 ? "main" : "worker " + std::to_string(buf->tid - 1)) << "\"}}";
+        first = false;
+        for (const auto& ev : buf->events) {
+            // Timestamps are in microseconds (fractional values are allowed)
+            file << ",\n{\"name\":\"" << ev.name << R"(","cat":"maxrank","ph":"X","pid":1,"tid":)" << buf->tid
+                 << ",\"ts\":" << static_cast<double>(ev.startNs) / 1000.0
+                 << ",\"dur\":" << static_cast<double>(ev.durNs) / 1000.0;
+            if (ev.arg >= 0) file << ",\"args\":{\"n\":" << ev.arg << "}";
+            file << "}";
+        }
+    }
+    file << "\n]}\n";
+}
+
+void clearTrace() {
+    std::lock_guard<std::mutex> lock(registryMutex);
+    for (const auto& buf : buffers) {
+        buf->events.clear();
+    }
+}
@@ -1,12 +1,10 @@
 #include "utils.h"
-#include <cstdio>
-#include <cstdlib>   // for exit(0)
-#include <cstring>   // for strtok
-#include <cmath>     // for std::ceil
-#include <filesystem>
+#include <cstdlib>
+#include <fstream>
 
 #if defined(_WIN32)
 #include <windows.h>
+#include <psapi.h>
 #elif defined(__linux__)
 #include <sys/sysinfo.h>
 #else
@@ -32,108 +30,74 @@ size_t getAvailableMemory() {
 #endif
 }
 
-std::vector<std::string> readCombinations(const int& dims) {
-    std::vector<std::string> comb;
-
-    // Supported dimension range: 2 to 9
-    if (dims < 2 || dims > 9) {
-        std::cerr << "Error in readCombinations: dimension "
-                  << dims << " not supported.\n";
-        return comb; // Return empty
+size_t getCurrentMemory() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
     }
+    return static_cast<size_t>(counters.WorkingSetSize);
 
-    // Recupera il path di *questo* file sorgente, così come è noto a compile-time.
-    std::filesystem::__cxx11::path thisSourceFile = std::filesystem::__cxx11::path(__FILE__);
-    // Ottiene la cartella che contiene il file sorgente.
-    std::filesystem::__cxx11::path thisSourceDir  = thisSourceFile.parent_path();
-    // A questo punto, “bin” è fisso rispetto alla cartella del file sorgente.
-    std::filesystem::__cxx11::path binDir         = thisSourceDir / "../bin";
-
-    // Costruisci l’array dei nomi di file nella cartella bin
-    std::string FileName[] = {
-        (binDir / "Comb2D.txt").string(),
-        (binDir / "Comb3D.txt").string(),
-        (binDir / "Comb4D.txt").string(),
-        (binDir / "Comb5D.txt").string(),
-        (binDir / "Comb6D.txt").string(),
-        (binDir / "Comb7D.txt").string(),
-        (binDir / "Comb8D.txt").string(),
-        (binDir / "Comb9D.txt").string()
-    };
-    std::string fileToOpen = FileName[dims - 2];
-
-    FILE* fp = std::fopen(fileToOpen.c_str(), "r");
-    if (!fp) {
-        std::cerr << "Error: cannot open file " << fileToOpen << std::endl;
-        std::exit(1);
+#elif defined(__linux__)
+    // VmRSS is the current resident set size, reported in kB
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmRSS:", 0) == 0) {
+            return static_cast<size_t>(std::strtoull(line.c_str() + 6, nullptr, 10)) * 1024;
+        }
     }
+    return 0;
+#endif
+}
 
-    char buf[512];
-    // First line should match dims
-    if (!std::fgets(buf, 512, fp)) {
-        std::cerr << "Error reading from " << fileToOpen << std::endl;
-        std::fclose(fp);
-        std::exit(1);
-    }
-    if (std::atoi(buf) != dims) {
-        std::cerr << "Error! Dimensions do not match for " << fileToOpen << std::endl;
-        std::fclose(fp);
-        std::exit(1);
+size_t getPeakMemory() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (!K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return 0;
     }
+    return static_cast<size_t>(counters.PeakWorkingSetSize);
 
-    // Read subsequent lines as binary strings
-    while (std::fgets(buf, 512, fp)) {
-        char* token = std::strtok(buf, " \n\t");
-        if (token) {
-            comb.emplace_back(token);
+#elif defined(__linux__)
+    // VmHWM is the peak resident set size, reported in kB
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return static_cast<size_t>(std::strtoull(line.c_str() + 6, nullptr, 10)) * 1024;
         }
     }
-    std::fclose(fp);
-    return comb;
+    return 0;
+#endif
 }
 
-bool MbrIsValid(const std::vector<std::array<float, 2>>& mbr,
-                const std::vector<std::string>& Comb,
-                int dims,
-                const float queryPlane[])
-{
-    int numAbove = 0;
-    int numBelow = 0;
-    long numOfVertices = static_cast<long>(Comb.size());
+bool resetPeakMemory() {
+#if defined(_WIN32)
+    // No way to reset PeakWorkingSetSize: callers get the process-wide peak
+    return false;
 
-    // Temporary storage for vertex coords
-    std::vector<double> coord(dims, 0.0);
-    coord.reserve(dims);
+#elif defined(__linux__)
+    // Writing 5 to clear_refs resets VmHWM to the current RSS (Linux >= 4.0)
+    std::ofstream clearRefs("/proc/self/clear_refs");
+    if (!clearRefs.is_open()) return false;
+    clearRefs << "5";
+    return static_cast<bool>(clearRefs.flush());
+#endif
+}
 
-    for (const auto& combination : Comb) {
-        float sumVal = 0.0f;
-        for (int j = 0; j < dims; ++j) {
-            coord[j] = (combination[j] == '0') ? mbr[j][0] : mbr[j][1];
-            sumVal += static_cast<float>(coord[j]);
-        }
-        // Compare sumVal to queryPlane[dims]
-        if (sumVal > queryPlane[dims]) {
-            ++numAbove;
-            // If some vertices are above and some are below => MBR intersects
-            if (numAbove > 0 && numBelow > 0) {
-                break;
-            }
-        } else if (sumVal < queryPlane[dims]) {
-            ++numBelow;
-            if (numAbove > 0 && numBelow > 0) {
-                break;
-            }
-        }
+bool MbrIsValid(const std::vector<std::array<float, 2>>& mbr) {
+    float maxSum = 0.0f;
+    for (const auto& range : mbr) {
+        maxSum += range[1];
     }
+    return maxSum < 1.0f;
+}
 
-    // If ALL vertices are above => MBR is invalid
-    if (numAbove == numOfVertices) {
-        return false;
-    }
-    // If ALL vertices are below => MBR is valid
-    if (numBelow == numOfVertices) {
-        return true;
+bool MbrIntersectsSimplex(const std::vector<std::array<float, 2>>& mbr) {
+    double minSum = 0.0;
+    for (const auto& range : mbr) {
+        minSum += range[0];
     }
-    // Otherwise, it intersects => not valid
-    return false;
+    return minSum <= 1.0;
 }
@@ -0,0 +1,87 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include "server.h"
+
+#if !defined(_WIN32)
+#include <cerrno>
+#include <csignal>
+#include <unistd.h>
+#endif
+
+/**
+ * Test client of maxrank_server.
+ *
+ * Usage: maxrank_client <socket> [request ...]
+ * Sends every request argument (e.g. "rank 17", "point 0.2 0.5 0.1", "stats") as one line,
+ * or the lines of stdin when there are none, and prints one response line per request.
+ * Exits with 1 if any response is an error.
+ */
+
+int main(const int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <socket> [request ...]\n"
+                  << "  e.g. " << argv[0] << " /tmp/maxrank.sock \"rank 17\" \"point 0.2 0.5 0.1\" stats\n";
+        return 1;
+    }
+#if defined(_WIN32)
+    std::cerr << "Unix domain sockets are not supported on this platform" << std::endl;
+    return 1;
+#else
+    // A refused or closed connection must surface as an error, not kill the client on write
+    std::signal(SIGPIPE, SIG_IGN);
+
+    std::vector<std::string> requests(argv + 2, argv + argc);
+    const bool fromStdin = requests.empty();
+
+    int fd;
+    try {
+        fd = connectServer(argv[1]);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    std::string buffer;
+    auto readLine = [&](std::string& line) {
+        size_t eol;
+        char chunk[4096];
+        while ((eol = buffer.find('\n')) == std::string::npos) {
+            const ssize_t n = read(fd, chunk, sizeof(chunk));
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            buffer.append(chunk, static_cast<size_t>(n));
+        }
+        line = buffer.substr(0, eol);
+        buffer.erase(0, eol + 1);
+        return true;
+    };
+
+    bool failed = false;
+    std::string request;
+    for (size_t i = 0; fromStdin ? static_cast<bool>(std::getline(std::cin, request)) : i < requests.size(); i++) {
+        if (!fromStdin) request = requests[i];
+        if (request.find_first_not_of(" \t\r") == std::string::npos) continue;  // no response to blank lines
+
+        const std::string msg = request + "\n";
+        if (write(fd, msg.data(), msg.size()) != static_cast<ssize_t>(msg.size())) {
+            // The server may have explained why it closed the connection (e.g. "err server busy")
+            std::string pendingError;
+            if (readLine(pendingError)) std::cout << pendingError << std::endl;
+            std::cerr << "Connection lost" << std::endl;
+            failed = true;
+            break;
+        }
+        std::string response;
+        if (!readLine(response)) {
+            std::cerr << "Connection closed by the server" << std::endl;
+            failed = true;
+            break;
+        }
+        std::cout << response << std::endl;
+        if (response.rfind("err", 0) == 0) failed = true;
+    }
+    close(fd);
+    return failed ? 1 : 0;
+#endif
+}
@@ -0,0 +1,101 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "autotune.h"
+#include "config.h"
+#include "csvutils.h"
+#include "reverse.h"
+
+/**
+ * Reverse MaxRank query: writes every record that can reach rank <= k under some
+ * weighting (e.g. "which items can make the top-10?"), see reverse.h.
+ *
+ * Usage: maxrank_reverse <datafile> <numRecords> <dimensions> <k> <outputfile> [config file | --flags]
+ * The output CSV has the columns id,rank_bound,source,w1,...,wd: rank_bound <= k is the rank
+ * at the witness weights w, an upper bound of the record's MaxRank (the best sampled rank for
+ * source "sampled"), source is "sampled" or "search". The algorithm flags of the main
+ * executable apply (--bound-samples=..., --max-capacity-qnode=..., --num-threads=...).
+ */
+
+int main(const int argc, char* argv[]) {
+    if (argc < 6) {
+        std::cerr << "Usage: " << argv[0] << " <datafile> <numRecords> <dimensions> <k> <outputfile> [config file | --flags]\n";
+        return 1;
+    }
+
+    const std::string datafile = argv[1];
+    const std::string outputFile = argv[5];
+    int numRecords, dimensions, k;
+    try {
+        numRecords = std::stoi(argv[2]);
+        dimensions = std::stoi(argv[3]);
+        k = std::stoi(argv[4]);
+        if (numRecords <= 0 || dimensions <= 0 || k <= 0) {
+            throw std::invalid_argument("Input numbers must be positive integers.");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid input for required parameters: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Same precedence as the main executable: tuned config below the explicit config / flags
+    auto applyOptionalArgs = [&]() {
+        if (argc < 7) return;
+        const std::string arg6 = argv[6];
+        if (std::filesystem::is_regular_file(arg6)) parseConfigFile(arg6);
+        else parseArgs(argc, argv, 6);
+    };
+    try {
+        applyOptionalArgs();
+        const std::string tunedPath = tunedConfigPath(datafile);
+        if (useTunedConfig && std::filesystem::exists(tunedPath)) {
+            parseConfigFile(tunedPath);
+            applyOptionalArgs();
+            std::cout << "Using tuned config: " << tunedPath << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid parameters: " << e.what() << std::endl;
+        return 1;
+    }
+    quietMode = 1;
+
+    const std::vector<Point> data = readCSV(datafile, numRecords, dimensions);
+
+    const auto start = std::chrono::high_resolution_clock::now();
+    ReverseStats stats;
+    std::vector<ReverseMatch> matches;
+    try {
+        matches = reverseMaxRank(data, k, &stats);
+    } catch (const std::exception& e) {
+        std::cerr << "Reverse query failed: " << e.what() << std::endl;
+        return 1;
+    }
+    const std::chrono::duration<double> elapsed = std::chrono::high_resolution_clock::now() - start;
+
+    std::ofstream out(outputFile);
+    if (!out.is_open()) {
+        std::cerr << "Could not open file: " << outputFile << std::endl;
+        return 1;
+    }
+    out << "id,rank_bound,source";
+    for (int d = 1; d <= dimensions; d++) out << ",w" << d;
+    out << "\n" << std::fixed << std::setprecision(15);
+    for (const auto& m : matches) {
+        out << m.id << "," << m.rank << "," << (m.sampled ? "sampled" : "search");
+        for (const double w : m.witness) out << "," << w;
+        out << "\n";
+    }
+
+    std::cout << stats.matches << " of " << stats.records << " record(s) can reach rank <= " << k << "\n"
+              << "  " << stats.candidates << " candidate(s) with fewer than " << k << " dominators\n"
+              << "  " << stats.sampled << " answered by sampling (" << stats.hull << " ranked first), "
+              << "rank_bound is their best sampled rank, an upper bound of the MaxRank\n"
+              << "  " << stats.searched << " decided by a query\n"
+              << "Total execution time: " << elapsed.count() << " seconds.\n"
+              << "Results written to " << outputFile << std::endl;
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <csignal>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "autotune.h"
+#include "config.h"
+#include "csvutils.h"
+#include "resultcache.h"
+#include "server.h"
+
+/**
+ * Long-running MaxRank server: loads the dataset once and answers requests
+ * ("rank <id>", "point <c1> ... <cd>", "stats", "quit", "shutdown", see server.h).
+ *
+ * Usage: maxrank_server <datafile> <numRecords> <dimensions> [config file | --flags]
+ *   --server-socket=<path>  listen on a Unix domain socket (default: stdin / stdout)
+ *   --server-workers=4      connections served concurrently
+ *   --server-queue=16       connections allowed to wait for a worker
+ * plus the algorithm flags of the main executable (--max-capacity-qnode=..., --result-cache=...).
+ * Logs go to stderr, so that stdout only carries responses in stdin mode.
+ */
+
+namespace {
+
+MaxRankServer* activeServer = nullptr;
+
+void onSignal(int) {
+    if (activeServer) activeServer->stop();
+}
+
+} // namespace
+
+int main(const int argc, char* argv[]) {
+    if (argc < 4) {
+        std::cerr << "Usage: " << argv[0] << " <datafile> <numRecords> <dimensions> [config file | --flags]\n"
+                  << "  --server-socket=<path> --server-workers=4 --server-queue=16\n";
+        return 1;
+    }
+
+    const std::string datafile = argv[1];
+    int numRecords, dimensions;
+    try {
+        numRecords = std::stoi(argv[2]);
+        dimensions = std::stoi(argv[3]);
+        if (numRecords <= 0 || dimensions <= 0) {
+            throw std::invalid_argument("Input numbers must be positive integers.");
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid input for required parameters: " << e.what() << std::endl;
+        return 1;
+    }
+
+    // Same precedence as the main executable: tuned config below the explicit config / flags
+    auto applyOptionalArgs = [&]() {
+        if (argc < 5) return;
+        const std::string arg4 = argv[4];
+        if (std::filesystem::is_regular_file(arg4)) parseConfigFile(arg4);
+        else parseArgs(argc, argv, 4);
+    };
+    try {
+        applyOptionalArgs();
+        const std::string tunedPath = tunedConfigPath(datafile);
+        if (useTunedConfig && std::filesystem::exists(tunedPath)) {
+            parseConfigFile(tunedPath);
+            applyOptionalArgs();
+            std::cerr << "Using tuned config: " << tunedPath << "\n";
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Invalid parameters: " << e.what() << std::endl;
+        return 1;
+    }
+    quietMode = 1;
+
+    const std::vector<Point> data = readCSV(datafile, numRecords, dimensions);
+    std::cerr << "Loaded " << data.size() << " records from " << datafile << std::endl;
+
+    std::unique_ptr<ResultCache> cache;
+    if (!resultCacheDir.empty()) {
+        cache = std::make_unique<ResultCache>(resultCacheDir, hashDataset(data), resultCacheParams(dimensions > 2 ? "hd" : "2d", 0));
+        std::cerr << "Result cache " << cache->path() << ": " << cache->size() << " results" << std::endl;
+    }
+
+    MaxRankServer server(data, serverWorkers, serverQueue, cache.get());
+    activeServer = &server;
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    try {
+        if (serverSocket.empty()) {
+            std::cerr << "Reading requests from stdin" << std::endl;
+            server.serveStream(std::cin, std::cout);
+        } else {
+            std::cerr << "Listening on " << serverSocket << " with " << serverWorkers << " worker(s)" << std::endl;
+            server.serveSocket(serverSocket);
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Server error: " << e.what() << std::endl;
+        activeServer = nullptr;
+        return 1;
+    }
+    activeServer = nullptr;
+
+    const ServerStats s = server.stats();
+    std::cerr << "Served " << s.requests << " request(s): " << s.rankQueries << " rank, " << s.pointQueries
+              << " point, " << s.memoHits << " memo hit(s), " << s.errors << " error(s)" << std::endl;
+    return 0;
+}